@@ -10,6 +10,7 @@
 #include <sstream>
 
 #include "linear/binary.h"
+#include "linear/memory.h"
 #include "linear/optional.h"
 
 namespace linear {
@@ -19,8 +20,10 @@ namespace type {
 /**
  * @class any any.h "linear/any.h"
  * represent any type object
- * An any object allocates more than 8192 bytes of memory.
+ * An any object that holds STR, BIN, EXT, ARRAY or MAP allocates more than 8192 bytes of memory.
  * This values is defined as default value of MSGPACK_ZONE_CHUNK_SIZE in deps/msgpack/include/msgpack/zone.h.
+ * The memory is immutable and shared among copies of the any object,
+ * so that copying is O(1), and assigning a new value allocates another one.
  */
 class any {
  public:
@@ -45,38 +48,35 @@ class any {
   /// @cond hidden
   any() : zone_(), object_(), type(NIL) {
   }
-  any(const any& a) : zone_() {
-    copy_msgpack_object(a.object_, &object_, zone_);
-    type = static_cast<linear::type::any::Type>(object_.type);
+  any(const any& a) : zone_(a.zone_), object_(a.object_), type(a.type) {
   }
   any(const linear::type::nil&) : zone_(), object_(), type(NIL) {
   }
-  any(const msgpack::object& o) : zone_() {
-    copy_msgpack_object(o, &object_, zone_);
-    type = static_cast<linear::type::any::Type>(object_.type);
+  any(const msgpack::object& o) : zone_(), object_(), type(NIL) {
+    assign(o);
   }
   template <typename Value>
-  any(const Value& value) : zone_(), object_(value, zone_), type(static_cast<linear::type::any::Type>(object_.type)) {
+  any(const Value& value) : zone_(), object_(make_object(value, &zone_)), type(static_cast<linear::type::any::Type>(object_.type)) {
   }
   ~any() {
   }
   template <typename Value>
   any& operator=(const Value& value) {
-    zone_.clear();
-    object_ = msgpack::object(value, zone_);
+    // never clear zone_, that may be shared with other copies
+    linear::shared_ptr<msgpack::zone> z;
+    object_ = make_object(value, &z);
+    zone_.swap(z);
     type = static_cast<linear::type::any::Type>(object_.type);
     return *this;
   }
   any& operator=(const any& a) {
-    zone_.clear();
-    copy_msgpack_object(a.object_, &object_, zone_);
-    type = static_cast<linear::type::any::Type>(object_.type);
+    zone_ = a.zone_;
+    object_ = a.object_;
+    type = a.type;
     return *this;
   }
   any& operator=(const msgpack::object& o) {
-    zone_.clear();
-    copy_msgpack_object(o, &object_, zone_);
-    type = static_cast<linear::type::any::Type>(object_.type);
+    assign(o);
     return *this;
   }
   bool operator<(const any& a) const {
@@ -111,7 +111,11 @@ class any {
    * @return msgpack::zone
    */
   const msgpack::zone& zone() const {
-    return zone_;
+    if (!zone_) {
+      static const msgpack::zone empty;
+      return empty;
+    }
+    return *zone_;
   }
   /// @endcond
 
@@ -160,14 +164,26 @@ class any {
     pk.pack(object_);
   }
   void msgpack_unpack(msgpack::object o) {
-    zone_.clear();
-    copy_msgpack_object(o, &object_, zone_);
-    type = static_cast<linear::type::any::Type>(object_.type);
+    assign(o);
   }
   template <typename MSGPACK_OBJECT>
   void msgpack_object(MSGPACK_OBJECT* o, msgpack::zone& z) const {
     copy_msgpack_object(object_, o, z);
   }
+  void swap(any& a) {
+    zone_.swap(a.zone_);
+    std::swap(object_, a.object_);
+    std::swap(type, a.type);
+  }
+  /**
+   * take over z that o is allocated in, instead of copying o.
+   * z is owned by this any (and its copies) after calling, and must not be modified.
+   */
+  void adopt(const msgpack::object& o, msgpack::zone* z) {
+    zone_.reset(z);
+    object_ = o;
+    type = static_cast<linear::type::any::Type>(object_.type);
+  }
   /// @endcond
 
  private:
@@ -175,6 +191,54 @@ class any {
     return !isprint(c);
   }
 
+  // convert value in a new zone, or no zone is needed for a scalar value (same as assign)
+  template <typename Value>
+  static msgpack::object make_object(const Value& value, linear::shared_ptr<msgpack::zone>* z) {
+    z->reset(new msgpack::zone());
+    return msgpack::object(value, **z);
+  }
+#define LINEAR_ANY_MAKE_SCALAR_OBJECT(Scalar)                                            \
+  static msgpack::object make_object(Scalar value, linear::shared_ptr<msgpack::zone>*) { \
+    return msgpack::object(value);                                                       \
+  }
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(bool)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(char)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(signed char)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(unsigned char)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(short)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(unsigned short)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(int)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(unsigned int)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(long)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(unsigned long)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(long long)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(unsigned long long)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(float)
+  LINEAR_ANY_MAKE_SCALAR_OBJECT(double)
+#undef LINEAR_ANY_MAKE_SCALAR_OBJECT
+
+  // copy o into a new zone, or no zone is needed if o has no reference
+  void assign(const msgpack::object& o) {
+    linear::shared_ptr<msgpack::zone> z;
+    msgpack::object obj;
+    switch (o.type) {
+    case msgpack::type::STR:
+    case msgpack::type::BIN:
+    case msgpack::type::EXT:
+    case msgpack::type::ARRAY:
+    case msgpack::type::MAP:
+      z.reset(new msgpack::zone());
+      copy_msgpack_object(o, &obj, *z);
+      break;
+    default:
+      obj = o;
+      break;
+    }
+    zone_.swap(z);
+    object_ = obj;
+    type = static_cast<linear::type::any::Type>(object_.type);
+  }
+
   void copy_msgpack_object(const msgpack::object& src, msgpack::object* dst, msgpack::zone& z) const {
     dst->type = src.type;
     switch (src.type) {
@@ -268,8 +332,8 @@ class any {
     }
   }
 
-  msgpack::zone   zone_;
-  msgpack::object object_;
+  linear::shared_ptr<msgpack::zone> zone_;
+  msgpack::object                   object_;
 
 public:
   /**
@@ -7,6 +7,9 @@
 #define LINEAR_CLIENT_H_
 
 #include "linear/event_loop.h"
+#include "linear/event_loop_pool.h"
+#include "linear/error.h"
+#include "linear/executor.h"
 
 namespace linear {
 
@@ -23,6 +26,14 @@ class LINEAR_EXTERN Client {
   virtual ~Client() {}
   /// @endcond
 
+  /**
+   * Call handlers on worker threads of executor instead of the event loop thread
+   * @param [in] executor linear::Executor object
+   * @return linear::Error object
+   * @note call this before creating sockets
+   */
+  virtual linear::Error SetExecutor(const linear::Executor& executor) const;
+
  protected:
   /// @cond hidden
   linear::shared_ptr<linear::ClientImpl> client_;
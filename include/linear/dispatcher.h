@@ -0,0 +1,147 @@
+/**
+ * @file dispatcher.h
+ * Dispatcher class definition
+ */
+
+#ifndef LINEAR_DISPATCHER_H_
+#define LINEAR_DISPATCHER_H_
+
+#include "linear/handler.h"
+
+namespace linear {
+
+class DispatcherImpl;
+
+/**
+ * @class Dispatcher dispatcher.h "linear/dispatcher.h"
+ * Handler that routes Requests and Notifies to callbacks registered by method name.\n
+ * A method is found by one hash lookup instead of comparing method strings one by one.
+ * Register all methods before starting servers or connecting sockets.
+ * Inherit this class to handle OnConnect, OnDisconnect, OnError and so on.
+ *
+ @code
+ static void Echo(const linear::Socket& socket, const linear::Request& request) {
+   linear::Response response(request.msgid, request.params);
+   response.Send(socket);
+ }
+
+ static void Log(const linear::Socket& socket, const linear::Notify& notify) {
+   std::cout << notify.params.stringify() << std::endl;
+ }
+
+ linear::shared_ptr<linear::Dispatcher> dispatcher(new linear::Dispatcher());
+ dispatcher->RegisterRequest("echo", Echo);
+ dispatcher->RegisterNotify("log", Log);
+ dispatcher->Seal();
+ linear::TCPServer server(dispatcher);
+ server.Start("127.0.0.1", 37800);
+ @endcode
+ */
+class LINEAR_EXTERN Dispatcher : public linear::Handler {
+ public:
+  /// @cond hidden
+  class ICallbackHolder {
+   public:
+    virtual ~ICallbackHolder() {}
+    virtual void Fire(const linear::Socket& socket, const linear::Message& message) const = 0;
+  };
+  /// @endcond
+
+ public:
+  /**
+   * Dispatcher Constructor
+   */
+  Dispatcher();
+  /// @cond hidden
+  virtual ~Dispatcher();
+  /// @endcond
+
+  /**
+   * register a callback for Requests of the method
+   * @param [in] method method name
+   * @param [in] callback function or functor called as callback(const linear::Socket&, const linear::Request&)
+   * @return linear::Error<br>
+   * linear::LNR_EEXIST if method is already registered, linear::LNR_EALREADY if sealed
+   */
+  template <typename CallbackType>
+  linear::Error RegisterRequest(const std::string& method, CallbackType callback);
+  /**
+   * register a callback for Notifies of the method
+   * @param [in] method method name
+   * @param [in] callback function or functor called as callback(const linear::Socket&, const linear::Notify&)
+   * @return linear::Error<br>
+   * linear::LNR_EEXIST if method is already registered, linear::LNR_EALREADY if sealed
+   */
+  template <typename CallbackType>
+  linear::Error RegisterNotify(const std::string& method, CallbackType callback);
+#if __cplusplus >= 201103L
+  /**
+   * register a typed function for Requests of the method (C++11 or later)\n
+   * params are converted directly into arguments of function, and the return value is sent as result.
+   * params must be an array that has the same number of elements as the arguments.
+   * for a unary function, the sole element of params is taken as the argument if it converts,
+   * or else params itself is taken as the argument.
+   * an error Response "invalid params" is sent if params cannot be converted,
+   * and exceptions thrown by function are propagated as is.
+   * @note the return value is converted into linear::type::any of Response before packed.
+   * @param [in] method method name
+   * @param [in] function function, lambda or functor, arguments and return value are
+   * primitive types, STL containers or types that have LINEAR_PACK
+   * @return linear::Error<br>
+   * linear::LNR_EEXIST if method is already registered, linear::LNR_EALREADY if sealed
+   *
+   @code
+   struct Point {
+     int x, y;
+     LINEAR_PACK(x, y);
+   };
+
+   dispatcher->Bind("add", [](int a, int b) { return a + b; });
+   dispatcher->Bind("norm", [](const Point& p) { return p.x * p.x + p.y * p.y; });
+   @endcode
+   */
+  template <typename FunctionType>
+  linear::Error Bind(const std::string& method, FunctionType function);
+#endif
+  /**
+   * fix registered methods, and rebuild the lookup table as a perfect hash
+   * @return linear::Error
+   */
+  linear::Error Seal();
+
+  /**
+   * routes Requests and Notifies to registered callbacks
+   * @see linear::Handler.OnMessage
+   */
+  virtual void OnMessage(const linear::Socket& socket, const linear::Message& message);
+  /**
+   * Callback function called for Responses, and for Requests and Notifies of unregistered methods.
+   * replies an error Response "method not found" to Requests by default.
+   * @param socket connected socket
+   * @param message linear::Message object ref.
+   */
+  virtual void OnUnhandledMessage(const linear::Socket& socket, const linear::Message& message);
+
+ private:
+  template <typename CallbackType>
+  class RequestCallbackHolder;
+  template <typename CallbackType>
+  class NotifyCallbackHolder;
+#if __cplusplus >= 201103L
+  template <typename FunctionType>
+  class BoundCallbackHolder;
+#endif
+
+  Dispatcher(const Dispatcher&);
+  Dispatcher& operator=(const Dispatcher&);
+
+  linear::Error Register(linear::message_type_t type, const std::string& method,
+                         const linear::shared_ptr<ICallbackHolder>& holder);
+
+  linear::shared_ptr<linear::DispatcherImpl> impl_;
+};
+
+}  // namespace linear
+
+#include "linear/private/dispatcher_priv.h"
+#endif  // LINEAR_DISPATCHER_H_
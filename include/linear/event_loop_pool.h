@@ -0,0 +1,75 @@
+/**
+ * @file event_loop_pool.h
+ * Event loop pool class definition
+ */
+
+#ifndef LINEAR_EVENT_LOOP_POOL_H_
+#define LINEAR_EVENT_LOOP_POOL_H_
+
+#include "linear/event_loop.h"
+
+namespace linear {
+
+class EventLoopPoolImpl;
+
+/**
+ * @class EventLoopPool event_loop_pool.h "linear/event_loop_pool.h"
+ * EventLoopPool class.
+ * enable to spread sockets created by a client over several event loops(a.k.a threads)
+ * @see linear::TCPClient, linear::SSLClient, linear::WSClient, linear::WSSClient
+ *
+ @code
+ // 4 threads share sockets created by the client
+ linear::EventLoopPool pool(4, linear::EventLoopPool::LEAST_SOCKETS);
+ linear::TCPClient client(handler, pool);
+ for (int i = 0; i < 5000; i++) {
+   linear::TCPSocket socket = client.CreateSocket("127.0.0.1", 37800);
+   socket.Connect();
+ }
+ @endcode
+ */
+class LINEAR_EXTERN EventLoopPool {
+ public:
+  /**
+   * @enum linear::EventLoopPool::Policy
+   * how to choose an event loop for a new socket
+   */
+  enum Policy {
+    ROUND_ROBIN,   //!< in turn
+    LEAST_SOCKETS  //!< the loop that has the fewest live sockets
+  };
+
+ public:
+  /**
+   * EventLoopPool Constructor
+   * @param [in] size number of event loops(threads), must be greater than 0
+   * @param [in] [policy] how to choose an event loop for a new socket
+   */
+  explicit EventLoopPool(size_t size, linear::EventLoopPool::Policy policy = ROUND_ROBIN);
+  /// @cond hidden
+  ~EventLoopPool();
+  /// @endcond
+
+  /**
+   * get number of event loops
+   * @return number of event loops
+   */
+  size_t GetSize() const;
+  /**
+   * get the event loop at index
+   * @param [in] index index of event loop (0 <= index < GetSize())
+   * @return linear::EventLoop object
+   */
+  const linear::EventLoop& GetEventLoop(size_t index) const;
+
+  /// @cond hidden
+  const linear::shared_ptr<linear::EventLoopPoolImpl> GetImpl() const;
+  /// @endcond
+
+ private:
+  linear::shared_ptr<linear::EventLoopPoolImpl> pool_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_EVENT_LOOP_POOL_H_
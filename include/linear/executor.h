@@ -0,0 +1,90 @@
+/**
+ * @file executor.h
+ * Executor class definition
+ */
+
+#ifndef LINEAR_EXECUTOR_H_
+#define LINEAR_EXECUTOR_H_
+
+#include <stdint.h>
+
+#include "linear/memory.h"
+#include "linear/private/extern.h"
+
+namespace linear {
+
+class ExecutorImpl;
+
+/**
+ * @class Executor executor.h "linear/executor.h"
+ * Executor class.
+ * runs linear::Handler callbacks on worker threads instead of event loop threads,
+ * so that handlers that do blocking I/O do not stall other sockets.\n
+ * callbacks for the same socket are called in order on the same worker thread.
+ * @see linear::Server.SetExecutor, linear::Client.SetExecutor
+ *
+ @code
+ linear::Executor executor(8);
+ linear::TCPServer server(handler);
+ server.SetExecutor(executor);
+ server.Start("127.0.0.1", 37800);
+ @endcode
+ */
+class LINEAR_EXTERN Executor {
+ public:
+  /**
+   * default max number of waiting callbacks per worker thread
+   */
+  static const size_t DEFAULT_MAX_QUEUE_SIZE = 1024;
+
+  /**
+   * @struct linear::Executor::Stats
+   * statistics of an executor
+   */
+  struct Stats {
+    size_t queued;       //!< number of callbacks waiting now
+    size_t max_queued;   //!< max number of callbacks waiting at once
+    uint64_t executed;   //!< number of callbacks executed
+    uint64_t dropped;    //!< number of messages dropped because the queue was full
+    uint64_t total_wait; //!< total time(usec) that executed callbacks waited
+    uint64_t max_wait;   //!< max time(usec) that a callback waited
+  };
+
+ public:
+  /**
+   * Executor Constructor
+   * @param [in] num_of_threads number of worker threads, must be greater than 0
+   * @param [in] [max_queue_size] max number of waiting callbacks per worker thread, 0 means no limit.\n
+   * event loop threads never wait for worker threads:
+   * while the queue is full, OnMessage of requests and notifies are dropped and counted in Stats::dropped,
+   * and other callbacks are queued over the limit.\n
+   * a dropped request is answered by an error response (result = nil, error = "server busy")
+   * from the event loop thread, and only notifies are dropped silently.
+   */
+  explicit Executor(size_t num_of_threads, size_t max_queue_size = DEFAULT_MAX_QUEUE_SIZE);
+  /// @cond hidden
+  ~Executor();
+  /// @endcond
+
+  /**
+   * get number of worker threads
+   * @return number of worker threads
+   */
+  size_t GetNumOfThreads() const;
+  /**
+   * get statistics, like queue depth and wait time
+   * @return linear::Executor::Stats
+   */
+  linear::Executor::Stats GetStats() const;
+
+  /// @cond hidden
+  const linear::shared_ptr<linear::ExecutorImpl> GetImpl() const;
+  /// @endcond
+
+ private:
+  linear::shared_ptr<linear::ExecutorImpl> executor_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_EXECUTOR_H_
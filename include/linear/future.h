@@ -0,0 +1,105 @@
+/**
+ * @file future.h
+ * Future class definition
+ */
+
+#ifndef LINEAR_FUTURE_H_
+#define LINEAR_FUTURE_H_
+
+#if __cplusplus >= 202002L
+# include <coroutine>
+#endif
+
+#include "linear/error.h"
+#include "linear/memory.h"
+
+namespace linear {
+
+class FutureImpl;
+class Response;
+
+/**
+ * @class Future future.h "linear/future.h"
+ * Future class.
+ * result of linear::Request.SendAsync,
+ * that becomes ready when a response is received, or the request fails or times out.\n
+ * with C++20 or later, it can be awaited in a coroutine.
+ * the coroutine is resumed on the event loop thread of the socket.
+ * @warning Wait, GetError and GetResponse block until ready,
+ * so do not call them on the event loop thread of the socket.
+ * @see linear::Request.SendAsync
+ *
+ @code
+ linear::Request request("add", params);
+ linear::Future future = request.SendAsync(socket, 1000);
+ if (future.GetError() == linear::Error(linear::LNR_OK)) {
+   std::cout << future.GetResponse().result.stringify() << std::endl;
+ }
+
+ // C++20 coroutine
+ linear::Future future = co_await request.SendAsync(socket, 1000);
+ @endcode
+ */
+class LINEAR_EXTERN Future {
+ public:
+  /// @cond hidden
+  explicit Future(const linear::shared_ptr<linear::FutureImpl>& impl);
+  virtual ~Future();
+  /// @endcond
+
+  /**
+   * check whether the result is ready or not
+   * @return true if ready
+   */
+  bool IsReady() const;
+  /**
+   * wait until the result is ready
+   */
+  void Wait() const;
+  /**
+   * get error of the request, wait until the result is ready
+   * @return linear::Error<br>
+   * linear::LNR_OK if a response is received, linear::LNR_ETIMEDOUT if the request times out,
+   * linear::LNR_ECANCELED if the socket is destroyed while waiting, or
+   * the error that happens while sending
+   */
+  const linear::Error& GetError() const;
+  /**
+   * get the response, wait until the result is ready
+   * @return linear::Response, that is valid only if GetError returns linear::LNR_OK
+   */
+  const linear::Response& GetResponse() const;
+
+  /// @cond hidden
+  // call callback(arg) once when ready, return false without calling if already ready.
+  // each registered callback is called, in order of registration
+  bool OnReady(void (*callback)(void*), void* arg) const;
+  const linear::shared_ptr<linear::FutureImpl> GetImpl() const;
+  /// @endcond
+
+#if __cplusplus >= 202002L
+  /// @cond hidden
+  bool await_ready() const {
+    return IsReady();
+  }
+  bool await_suspend(std::coroutine_handle<> handle) const {
+    return OnReady(Resume, handle.address());
+  }
+  linear::Future await_resume() const {
+    return *this;
+  }
+  /// @endcond
+
+ private:
+  static void Resume(void* address) {
+    std::coroutine_handle<>::from_address(address).resume();
+  }
+#endif
+
+ private:
+  linear::shared_ptr<linear::FutureImpl> impl_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_FUTURE_H_
@@ -5,6 +5,7 @@
 #ifndef LINEAR_GROUP_H_
 #define LINEAR_GROUP_H_
 
+#include <iterator>
 #include <vector>
 #include <set>
 
@@ -24,6 +25,112 @@ namespace linear {
  * @see LINEAR_BROADCAST_GROUP
  */
 class LINEAR_EXTERN Group {
+ public:
+  /**
+   * @class linear::Group::Snapshot
+   * immutable sequence of linear::Socket sorted by id, that is never changed by Join or Leave after taken
+   *
+   @code
+   linear::Group::Snapshot sockets = linear::Group::GetSnapshot("group_name");
+   for (linear::Group::Snapshot::const_iterator it = sockets.begin(); it != sockets.end(); it++) {
+     (*it).Send(notify);
+   }
+   @endcode
+   */
+  class LINEAR_EXTERN Snapshot {
+   public:
+    /// @cond hidden
+    // sockets are split into sorted chunks, so that Join and Leave copy only one of them
+    typedef std::vector<linear::Socket> Chunk;
+    typedef std::vector<linear::shared_ptr<const Chunk> > Chunks;
+    /// @endcond
+
+    /**
+     * @class linear::Group::Snapshot::const_iterator
+     * forward iterator of linear::Group::Snapshot
+     */
+    class LINEAR_EXTERN const_iterator {
+     public:
+      /// @cond hidden
+      typedef std::forward_iterator_tag iterator_category;
+      typedef linear::Socket value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const linear::Socket* pointer;
+      typedef const linear::Socket& reference;
+
+      const_iterator(const Chunks* chunks, size_t chunk, size_t index)
+        : chunks_(chunks), chunk_(chunk), index_(index) {}
+      /// @endcond
+
+      reference operator*() const {
+        return (*(*chunks_)[chunk_])[index_];
+      }
+      pointer operator->() const {
+        return &(*(*chunks_)[chunk_])[index_];
+      }
+      const_iterator& operator++() {
+        if (++index_ == (*chunks_)[chunk_]->size()) {
+          chunk_++;
+          index_ = 0;
+        }
+        return *this;
+      }
+      const_iterator operator++(int) {
+        const_iterator it(*this);
+        ++(*this);
+        return it;
+      }
+      bool operator==(const const_iterator& it) const {
+        return (chunk_ == it.chunk_ && index_ == it.index_);
+      }
+      bool operator!=(const const_iterator& it) const {
+        return !(*this == it);
+      }
+
+     private:
+      const Chunks* chunks_;
+      size_t chunk_;
+      size_t index_;
+    };
+
+    /// @cond hidden
+    Snapshot() : size_(0) {}
+    Snapshot(const linear::shared_ptr<const Chunks>& chunks, size_t size) : chunks_(chunks), size_(size) {}
+    const linear::shared_ptr<const Chunks>& GetChunks() const {
+      return chunks_;
+    }
+    /// @endcond
+
+    /**
+     * get an iterator to the first socket.
+     */
+    const_iterator begin() const {
+      return const_iterator(chunks_.get(), 0, 0);
+    }
+    /**
+     * get an iterator past the last socket.
+     */
+    const_iterator end() const {
+      return const_iterator(chunks_.get(), chunks_ ? chunks_->size() : 0, 0);
+    }
+    /**
+     * get number of sockets.
+     */
+    size_t size() const {
+      return size_;
+    }
+    /**
+     * check whether the snapshot is empty or not.
+     */
+    bool empty() const {
+      return (size_ == 0);
+    }
+
+   private:
+    linear::shared_ptr<const Chunks> chunks_;
+    size_t size_;
+  };
+
  public:
   /**
    * get list of group names.
@@ -36,6 +143,12 @@ class LINEAR_EXTERN Group {
    * @return socket set
    */
   static std::set<linear::Socket> Get(const std::string& name);
+  /**
+   * get linear::Socket that belongs to the specific group without copying them.
+   * @param name group name
+   * @return snapshot of the group at the time, that is empty if the group does not exist
+   */
+  static linear::Group::Snapshot GetSnapshot(const std::string& name);
   /**
    * joins the specific linear::Socket to the specific group.
    * @param name group name
@@ -57,7 +57,7 @@ class LINEAR_EXTERN Handler {
      switch(message.type) {
      case linear::REQUEST:
        {
-         linear::Request request = message.as<linear::Request>();
+         const linear::Request& request = message.as<linear::Request>();
          std::cout << "recv request: msgid = " << request.msgid
                    << ", method = " << request.method
                    << ", params = " << request.params.stringify() << std::endl;
@@ -65,7 +65,7 @@ class LINEAR_EXTERN Handler {
        break;
      case linear::RESPONSE:
        {
-         linear::Response response = message.as<linear::Response>();
+         const linear::Response& response = message.as<linear::Response>();
          std::cout << "recv response: msgid = " << response.msgid
                    << ", result = " << response.result.stringify()
                    << ", error = " << response.error.stringify() << std::endl;
@@ -73,7 +73,7 @@ class LINEAR_EXTERN Handler {
        break;
      case linear::NOTIFY:
        {
-         linear::Notify notify = message.as<linear::Notify>();
+         const linear::Notify& notify = message.as<linear::Notify>();
          std::cout << "recv notify: "
                    << "method = " << notify.method
                    << ", params = " << notify.params.stringify() << std::endl;
@@ -102,7 +102,7 @@ class LINEAR_EXTERN Handler {
      switch(message.type) {
      case linear::REQUEST:
        {
-         linear::Request request = message.as<linear::Request>();
+         const linear::Request& request = message.as<linear::Request>();
          std::cerr << "error to send request: msgid = " << request.msgid
                    << ", method = " << request.method
                    << ", params = " << request.params.stringify()
@@ -111,7 +111,7 @@ class LINEAR_EXTERN Handler {
        break;
      case linear::RESPONSE:
        {
-         linear::Response response = message.as<linear::Response>();
+         const linear::Response& response = message.as<linear::Response>();
          std::cerr << "error to send response: msgid = " << response.msgid
                    << ", result = " << response.result.stringify()
                    << ", error = " << response.error.stringify()
@@ -120,7 +120,7 @@ class LINEAR_EXTERN Handler {
        break;
      case linear::NOTIFY:
        {
-         linear::Notify notify = message.as<linear::Notify>();
+         const linear::Notify& notify = message.as<linear::Notify>();
          std::cerr << "error to send notify: "
                    << "method = " << notify.method
                    << ", params = " << notify.params.stringify()
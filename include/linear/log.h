@@ -148,6 +148,25 @@ LINEAR_EXTERN void DisableFile();
  **/
 LINEAR_EXTERN void DisableCallback();
 
+/**
+ * write logs on a background thread
+ *
+ * LINEAR_LOG queues records into a bounded lock-free ring and returns
+ * without waiting for the output of stderr, file and callback.
+ * when the ring is full, new records are dropped,
+ * and the number of dropped records is written as a warning.
+ * @param capacity [in] max number of queued records, rounded up to a power of 2
+ * @note call EnableAsync() and DisableAsync() while no other thread writes logs,
+ * and call DisableAsync() before disabling other outputs at the end of your application
+ * @note callback function is called on the background thread
+ **/
+LINEAR_EXTERN bool EnableAsync(size_t capacity = 4096);
+
+/**
+ * write all queued logs and stop the background thread
+ **/
+LINEAR_EXTERN void DisableAsync();
+
 /**
  * colorize logs
  * effects only LogStderr
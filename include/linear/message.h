@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "linear/any.h"
+#include "linear/future.h"
 #include "linear/socket.h"
 
 #define LINEAR_PACK(...) MSGPACK_DEFINE(__VA_ARGS__)
@@ -49,11 +50,13 @@ class LINEAR_EXTERN Message {
 
   /**
    * downcast method to get concrete messages
+   * @return reference of the concrete message, that is valid while this message is valid.\n
+   * assign it to a value (not a reference) if you need a copy.
    * @see linear::Handler.OnMessage, linear::Handler.OnError
    */
   template <typename Value>
-  inline Value as() const {
-    return dynamic_cast<Value&>(const_cast<linear::Message&>(*this));
+  inline const Value& as() const {
+    return dynamic_cast<const Value&>(*this);
   }
 
  public:
@@ -139,7 +142,7 @@ class LINEAR_EXTERN Request : public linear::Message {
   /**
    * send request to peer node with timeout
    * @param socket a linear::Socket object
-   * @param timeout request timeout (msec)
+   * @param timeout request timeout (msec), 0 means waiting for response without timeout
    * @note we may change to use Socket.Send mainly
    */
   linear::Error Send(const linear::Socket& socket, int timeout) const;
@@ -147,7 +150,7 @@ class LINEAR_EXTERN Request : public linear::Message {
    * send request to peer node with timeout and recv OnResponse callback by Closure
    * (ignore all of error)
    * @param socket a linear::Socket object
-   * @param timeout request timeout (msec)
+   * @param timeout request timeout (msec), 0 means waiting for response without timeout
    * @param on_response OnResponse Callback function
    * @note EXPERIMENTAL: we may move this method into Socket.Send
    */
@@ -156,19 +159,46 @@ class LINEAR_EXTERN Request : public linear::Message {
   /**
    * send request to peer node with timeout and recv OnResponse and OnError callback by Closure
    * @param socket a linear::Socket object
-   * @param timeout request timeout (msec)
+   * @param timeout request timeout (msec), 0 means waiting for response without timeout
    * @param on_response OnResponse Callback function
    * @param on_error OnError Callback function
    * @note EXPERIMENTAL: we may move this method into Socket.Send
    */
   template <typename ResponseCallbackType, typename ErrorCallbackType>
   linear::Error Send(const linear::Socket& socket, int timeout, ResponseCallbackType& on_response, ErrorCallbackType& on_error);
+  /**
+   * send request to peer node with timeout and get the result by linear::Future
+   * instead of Handler::OnMessage and Handler::OnError
+   * @param socket a linear::Socket object
+   * @param timeout request timeout (msec), 0 means waiting for response without timeout
+   * @return linear::Future, that is already ready if fail to send
+   * @note this request is not changed. a completion state is allocated for each call,
+   * and shared by the future and the copy of this request waiting for response
+   *
+   @code
+   std::vector<linear::Future> futures;
+   for (int i = 0; i < 100; i++) {
+     linear::Request request("add", i);
+     futures.push_back(request.SendAsync(socket, 1000));
+   }
+   for (size_t i = 0; i < futures.size(); i++) {
+     if (futures[i].GetError() == linear::Error(linear::LNR_OK)) {
+       std::cout << futures[i].GetResponse().result.stringify() << std::endl;
+     }
+   }
+   @endcode
+   */
+  linear::Future SendAsync(const linear::Socket& socket, int timeout) const;
 
   /// @cond hidden
+  bool HasFuture() const;
+  void CompleteFuture(const linear::Response& response) const;
+  void CompleteFuture(const linear::Error& error) const;
   bool HasResponseCallback() const;
   bool HasErrorCallback() const;
   void FireResponseCallback(const linear::Socket& socket, const linear::Response& response) const;
   void FireErrorCallback(const linear::Socket& socket, const linear::Request& request, const linear::Error& error) const;
+  void swap(linear::Request& request);
   /// @endcond
 
  private:
@@ -182,6 +212,7 @@ class LINEAR_EXTERN Request : public linear::Message {
 
   linear::shared_ptr<IResponseCallbackHolder> on_response_holder_;
   linear::shared_ptr<IErrorCallbackHolder> on_error_holder_;
+  linear::shared_ptr<linear::FutureImpl> future_;
 
  public:
   /**
@@ -294,7 +325,7 @@ class LINEAR_EXTERN Response : public linear::Message {
      switch(message.type) {
      case linear::REQUEST:
        {
-         linear::Request request = message.as<linear::Request>();
+         const linear::Request& request = message.as<linear::Request>();
          linear::Response response(request.msgid, std::string("result"));
          response.Send(socket);
          break;
@@ -307,7 +338,8 @@ class LINEAR_EXTERN Response : public linear::Message {
 
  public:
   /**
-   * reference of original Request
+   * reference of original Request\n
+   * the pending Request is handed over to the Response without copying, and params are shared with it.
    */
   linear::Request request;
   /**
@@ -0,0 +1,107 @@
+/**
+ * @file packed_message.h
+ * PackedMessage class definition
+ */
+
+#ifndef LINEAR_PACKED_MESSAGE_H_
+#define LINEAR_PACKED_MESSAGE_H_
+
+#include "linear/message.h"
+
+namespace linear {
+
+class PackedMessageImpl;
+
+/**
+ * @class PackedMessage packed_message.h "linear/packed_message.h"
+ * A Request, Response or Notify serialized once, that can be sent many times without serializing again.
+ * @note
+ * Copying PackedMessage is cheap, the serialized data is shared and never modified.\n
+ * A Request is sent with a new msgid whenever it is sent,
+ * so use msgid of Response (or Response.request) to identify it.
+ *
+ @code
+ linear::Notify notify("snapshot", snapshot);
+ linear::PackedMessage packed(notify);  // serialize only once here
+ for (std::vector<linear::Socket>::iterator it = sockets.begin(); it != sockets.end(); it++) {
+   packed.Send(*it);
+ }
+ @endcode
+ */
+class LINEAR_EXTERN PackedMessage {
+ public:
+  /**
+   * Constructor for an empty PackedMessage (type == linear::UNDEFINED)
+   */
+  PackedMessage();
+  /**
+   * Constructor to serialize a message
+   * @param message linear::Request, linear::Response or linear::Notify
+   * @note GetType() returns linear::UNDEFINED when fail to serialize
+   */
+  explicit PackedMessage(const linear::Message& message);
+  /**
+   * Constructor from msgpack-encoded data
+   * @param data msgpack-encoded Request, Response or Notify
+   * @param size size of data
+   * @note GetType() returns linear::UNDEFINED when data is not a valid message
+   */
+  PackedMessage(const char* data, size_t size);
+  PackedMessage(const linear::PackedMessage& message);
+  linear::PackedMessage& operator=(const linear::PackedMessage& message);
+  ~PackedMessage();
+
+  /**
+   * get type of packed message
+   * @return linear::REQUEST, linear::RESPONSE, linear::NOTIFY or linear::UNDEFINED
+   */
+  linear::message_type_t GetType() const;
+  /**
+   * get msgpack-encoded data
+   * @return pointer to data (NULL when empty)
+   */
+  const char* GetData() const;
+  /**
+   * get size of msgpack-encoded data
+   * @return size
+   */
+  size_t GetSize() const;
+  /**
+   * send packed message to peer node
+   * @param socket a linear::Socket object
+   * @return linear::Error object
+   */
+  linear::Error Send(const linear::Socket& socket) const;
+  /**
+   * send packed message to peer node
+   * @param socket a linear::Socket object
+   * @param timeout request timeout (msec), used only for Request.
+   * 0 means waiting for response without timeout
+   * @return linear::Error object
+   */
+  linear::Error Send(const linear::Socket& socket, int timeout) const;
+  /**
+   * send packed notify to group
+   * @param group_name socket group
+   * @see linear::Group
+   */
+  void Send(const std::string& group_name) const;
+  /**
+   * send packed notify to group except for specified socket
+   * @param group_name socket group
+   * @param except_socket excepting socket
+   * @see linear::Group
+   */
+  void Send(const std::string& group_name, const linear::Socket& except_socket) const;
+
+  /// @cond hidden
+  const linear::shared_ptr<linear::PackedMessageImpl>& GetImpl() const;
+  /// @endcond
+
+ private:
+  linear::shared_ptr<linear::PackedMessageImpl> message_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_PACKED_MESSAGE_H_
@@ -0,0 +1,199 @@
+/**
+ * @file dispatcher_priv.h
+ * Implementations of Dispatcher class templates
+ */
+
+#ifndef LINEAR_PRIVATE_DISPATCHER_PRIV_H_
+#define LINEAR_PRIVATE_DISPATCHER_PRIV_H_
+
+#if __cplusplus >= 201103L
+# include <new>
+# include <tuple>
+# include <typeinfo>
+# include <type_traits>
+#endif
+
+namespace linear {
+
+template <typename CallbackType>
+class Dispatcher::RequestCallbackHolder : public Dispatcher::ICallbackHolder {
+ public:
+  RequestCallbackHolder(CallbackType callback) : callback_(callback) {}
+  virtual ~RequestCallbackHolder() {}
+
+  void Fire(const linear::Socket& socket, const linear::Message& message) const {
+    callback_(socket, static_cast<const linear::Request&>(message));
+  }
+
+ private:
+  CallbackType callback_;
+};
+
+template <typename CallbackType>
+class Dispatcher::NotifyCallbackHolder : public Dispatcher::ICallbackHolder {
+ public:
+  NotifyCallbackHolder(CallbackType callback) : callback_(callback) {}
+  virtual ~NotifyCallbackHolder() {}
+
+  void Fire(const linear::Socket& socket, const linear::Message& message) const {
+    callback_(socket, static_cast<const linear::Notify&>(message));
+  }
+
+ private:
+  CallbackType callback_;
+};
+
+template <typename CallbackType>
+linear::Error Dispatcher::RegisterRequest(const std::string& method, CallbackType callback) {
+  return Register(linear::REQUEST, method,
+                  linear::shared_ptr<ICallbackHolder>(new RequestCallbackHolder<CallbackType>(callback)));
+}
+
+template <typename CallbackType>
+linear::Error Dispatcher::RegisterNotify(const std::string& method, CallbackType callback) {
+  return Register(linear::NOTIFY, method,
+                  linear::shared_ptr<ICallbackHolder>(new NotifyCallbackHolder<CallbackType>(callback)));
+}
+
+#if __cplusplus >= 201103L
+
+namespace bind {
+
+template <size_t... I>
+struct index_sequence {};
+
+template <size_t N, size_t... I>
+struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct make_index_sequence<0, I...> {
+  typedef index_sequence<I...> type;
+};
+
+template <typename FunctionType>
+struct function_traits : function_traits<decltype(&FunctionType::operator())> {};
+
+template <typename R, typename... Args>
+struct function_traits<R (*)(Args...)> {
+  typedef R result_type;
+  typedef std::tuple<typename std::decay<Args>::type...> arguments;
+  typedef typename make_index_sequence<sizeof...(Args)>::type indices;
+  static const size_t arity = sizeof...(Args);
+};
+
+template <typename R, typename... Args>
+struct function_traits<R (Args...)> : function_traits<R (*)(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct function_traits<R (C::*)(Args...)> : function_traits<R (*)(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct function_traits<R (C::*)(Args...) const> : function_traits<R (*)(Args...)> {};
+
+// params must be an array that has an element for each argument
+template <typename Arguments, size_t... I>
+inline Arguments Convert(const msgpack::object& params, index_sequence<I...>) {
+  if (params.type != msgpack::type::ARRAY || params.via.array.size != sizeof...(I)) {
+    throw std::bad_cast();
+  }
+  return Arguments(params.via.array.ptr[I].as<typename std::tuple_element<I, Arguments>::type>()...);
+}
+
+template <typename Arguments>
+inline Arguments Convert(const msgpack::object& params, index_sequence<>) {
+  if (!params.is_nil() && (params.type != msgpack::type::ARRAY || params.via.array.size != 0)) {
+    throw std::bad_cast();
+  }
+  return Arguments();
+}
+
+// the only argument is the sole element of params if it converts, or params itself,
+// so that both [<Point>] and <Point> (packed as [x, y]) are taken as a Point, and [3] as std::vector<int>{3}
+template <typename Arguments>
+inline Arguments Convert(const msgpack::object& params, index_sequence<0>) {
+  typedef typename std::tuple_element<0, Arguments>::type Argument;
+  if (params.type == msgpack::type::ARRAY && params.via.array.size == 1) {
+    try {
+      return Arguments(params.via.array.ptr[0].as<Argument>());
+    } catch(const std::bad_cast&) {
+    }
+  }
+  return Arguments(params.as<Argument>());
+}
+
+// the result is converted into linear::type::any by Response, and packed from it
+template <typename R>
+struct Caller {
+  template <typename FunctionType, typename Arguments, size_t... I>
+  static void Call(FunctionType& function, const linear::Socket& socket, const linear::Request& request,
+                   Arguments& args, index_sequence<I...>) {
+    (void)(args);
+    linear::Response response(request.msgid, function(std::get<I>(args)...));
+    response.Send(socket);
+  }
+};
+
+template <>
+struct Caller<void> {
+  template <typename FunctionType, typename Arguments, size_t... I>
+  static void Call(FunctionType& function, const linear::Socket& socket, const linear::Request& request,
+                   Arguments& args, index_sequence<I...>) {
+    (void)(args);
+    function(std::get<I>(args)...);
+    linear::Response response(request.msgid, linear::type::nil());
+    response.Send(socket);
+  }
+};
+
+}  // namespace bind
+
+template <typename FunctionType>
+class Dispatcher::BoundCallbackHolder : public Dispatcher::ICallbackHolder {
+ public:
+  BoundCallbackHolder(FunctionType function) : function_(function) {}
+  virtual ~BoundCallbackHolder() {}
+
+  void Fire(const linear::Socket& socket, const linear::Message& message) const {
+    typedef bind::function_traits<FunctionType> traits;
+    const linear::Request& request = static_cast<const linear::Request&>(message);
+    // convert all arguments before calling, and only conversion errors are answered as invalid params
+    typename std::aligned_storage<sizeof(Arguments), std::alignment_of<Arguments>::value>::type storage;
+    Arguments* args = NULL;
+    try {
+      args = new (&storage) Arguments(bind::Convert<Arguments>(request.params.object(),
+                                                               typename traits::indices()));
+    } catch(const std::bad_cast&) {
+      linear::Response response(request.msgid, linear::type::nil(), std::string("invalid params"));
+      response.Send(socket);
+      return;
+    }
+    Destroyer destroyer(args);
+    bind::Caller<typename traits::result_type>::Call(function_, socket, request, *args,
+                                                     typename traits::indices());
+  }
+
+ private:
+  typedef typename bind::function_traits<FunctionType>::arguments Arguments;
+  // destroys arguments even if function throws
+  struct Destroyer {
+    explicit Destroyer(Arguments* args) : args_(args) {}
+    ~Destroyer() {
+      args_->~Arguments();
+    }
+    Arguments* args_;
+  };
+
+  mutable FunctionType function_;
+};
+
+template <typename FunctionType>
+linear::Error Dispatcher::Bind(const std::string& method, FunctionType function) {
+  return Register(linear::REQUEST, method,
+                  linear::shared_ptr<ICallbackHolder>(new BoundCallbackHolder<FunctionType>(function)));
+}
+
+#endif
+
+}  // namespace linear
+
+#endif  // LINEAR_PRIVATE_DISPATCHER_PRIV_H_
@@ -8,6 +8,7 @@
 
 #include "linear/error.h"
 #include "linear/event_loop.h"
+#include "linear/executor.h"
 
 namespace linear {
 
@@ -19,25 +20,48 @@ class ServerImpl;
  */
 class LINEAR_EXTERN Server {
  public:
+  //! default backlog of listen
+  static const int DEFAULT_BACKLOG = 128;
+
   /// @cond hidden
   Server() {}
   virtual ~Server() {}
   /// @endcond
 
   /**
-   * Set number of clients limit
+   * Set number of clients limit,
+   * connections over the limit are closed at accept without calling handlers
    * @param [in] max_clients number of clients
    * default == 0: no limit
    * @return linear::Error object
    */
   virtual linear::Error SetMaxClients(size_t max_clients) const;
+  /**
+   * Set number of connections accepted per second,
+   * connections over the rate are closed at accept without calling handlers
+   * (WS and WSS servers respond 503 Service Unavailable)
+   * @param [in] rate number of connections per second, bursts up to rate connections are accepted
+   * default == 0: no limit
+   * @return linear::Error object
+   */
+  virtual linear::Error SetMaxAcceptRate(size_t rate) const;
+  /**
+   * Call handlers on worker threads of executor instead of the event loop thread
+   * @param [in] executor linear::Executor object
+   * @return linear::Error object
+   * @note call this before Start
+   */
+  virtual linear::Error SetExecutor(const linear::Executor& executor) const;
   /**
    * Starts a server with specified parameters.
    * @param [in] hostname IPAddr or FQDN of host
    * @param [in] port portnumber
+   * @param [in] backlog max length of the queue of pending connections,
+   * that is capped by the OS (e.g. net.core.somaxconn on Linux)
    * @return linear::Error object
    */
-  virtual linear::Error Start(const std::string& hostname, int port) const;
+  virtual linear::Error Start(const std::string& hostname, int port,
+                              int backlog = linear::Server::DEFAULT_BACKLOG) const;
   /**
    * Stops a server.
    * @return linear::Error object
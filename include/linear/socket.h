@@ -13,6 +13,9 @@
 namespace linear {
 
 class Message;
+class PackedMessage;
+class Request;
+class Response;
 class SocketImpl;
 
 /**
@@ -92,6 +95,17 @@ class LINEAR_EXTERN Socket {
    * @see linear::Socket::DEFAULT_MAX_BUFFER_SIZE
    */
   virtual linear::Error SetMaxRecvBufferSize(size_t limit) const;
+  /**
+   * enable or disable write coalescing.
+   * messages sent in one iteration of event loop are gathered and written at once.
+   * @param [in] enable true: gather messages, false: write each message (default)
+   * @param [in] cork_usec corking window (usec) to wait for more messages to gather.
+   * rounded up to milliseconds, and 0 means to flush at next iteration of event loop.
+   * @return linear::Error object
+   * @note gathered messages are flushed without waiting for the corking window when they exceed 64KB,
+   * or when the socket is disconnected.
+   */
+  virtual linear::Error SetWriteCoalescing(bool enable, unsigned int cork_usec = 0) const;
   /**
    * connect to target.
    * @param [in] timeout connect timeout(msec)\n
@@ -158,10 +172,42 @@ class LINEAR_EXTERN Socket {
   virtual const linear::Addrinfo& GetSelfInfo() const;
   /**
    * get peer socket information.
+   * host names of client sockets are resolved while connecting,
+   * so until connected, proto may be linear::Addrinfo::UNKNOWN and addr may be the host name.
    * @return linear::Addrinfo
    */
   virtual const linear::Addrinfo& GetPeerInfo() const;
 
+  /**
+   * send packed message to peer node without serializing again.
+   * @param [in] message linear::PackedMessage object
+   * @param [in] timeout request timeout (msec), used only for Request.
+   * 0 means waiting for response without timeout
+   * @return linear::Error object
+   * @see linear::PackedMessage
+   */
+  virtual linear::Error Send(const linear::PackedMessage& message, int timeout = 30000) const;
+  /**
+   * send request to peer node and wait for the response.
+   * @param [in] request linear::Request object
+   * @param [in] timeout request timeout (msec), 0 means waiting for response without timeout
+   * @param [out] response linear::Response object received
+   * @return linear::Error object<br>
+   * linear::LNR_ETIMEDOUT if the request times out,
+   * linear::LNR_EPERM if called on the event loop thread of this socket,
+   * where the response can never be received while waiting
+   * @note Handler::OnMessage and Handler::OnError are not called for the request
+   *
+   @code
+   linear::Response response;
+   linear::Error err = socket.Call(linear::Request("add", params), 1000, &response);
+   if (err == linear::Error(linear::LNR_OK)) {
+     std::cout << response.result.stringify() << std::endl;
+   }
+   @endcode
+   */
+  virtual linear::Error Call(const linear::Request& request, int timeout, linear::Response* response) const;
+
   // @cond hidden
   virtual linear::Error Send(const linear::Message& message, int timeout = 30000) const;
   // @endcond
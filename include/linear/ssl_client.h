@@ -40,6 +40,15 @@ class LINEAR_EXTERN SSLClient : public Client {
    */
   SSLClient(const linear::shared_ptr<linear::Handler>& handler,
             const linear::EventLoop& loop);
+  /**
+   * Constructor
+   * @param [in] handler application defined behavior.
+   * @param [in] context common linear::SSLContext object
+   * @param [in] pool eventloop(thread) pool object, sockets are spread over loops of the pool
+   */
+  SSLClient(const linear::shared_ptr<linear::Handler>& handler,
+            const linear::SSLContext& context,
+            const linear::EventLoopPool& pool);
   /**
    * Set common linear::SSLContext into Client Object.
    * If you can not provide linear::SSLContext when construct SSLClient, call this method.
@@ -30,6 +30,13 @@ class LINEAR_EXTERN TCPClient : public Client {
    */
   TCPClient(const linear::shared_ptr<linear::Handler>& handler,
             const linear::EventLoop& loop = linear::EventLoop::GetDefault());
+  /**
+   * Constructor
+   * @param [in] handler application defined behavior.
+   * @param [in] pool eventloop(thread) pool object, sockets are spread over loops of the pool
+   */
+  TCPClient(const linear::shared_ptr<linear::Handler>& handler,
+            const linear::EventLoopPool& pool);
   /**
    * Create new TCPSocket Object.
    * @param [in] hostname hostname or IPAddr of a target server.
@@ -39,6 +39,15 @@ class LINEAR_EXTERN WSClient : public Client {
    */
   WSClient(const linear::shared_ptr<linear::Handler>& handler,
            const linear::EventLoop& loop);
+  /**
+   * Constructor
+   * @param [in] handler application defined behavior.
+   * @param [in] request_context common linear::WSRequestContext object
+   * @param [in] pool eventloop(thread) pool object, sockets are spread over loops of the pool
+   */
+  WSClient(const linear::shared_ptr<linear::Handler>& handler,
+           const linear::WSRequestContext& request_context,
+           const linear::EventLoopPool& pool);
   /**
    * Set common linear::WSRequestContext into Client Object.
    * If you can not provide linear::WSRequestContext when construct WSClient, call this method.
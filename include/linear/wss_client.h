@@ -59,6 +59,17 @@ class LINEAR_EXTERN WSSClient : public Client {
    * @param [in] loop eventloop(thread) object
    */
   WSSClient(const linear::shared_ptr<linear::Handler>& handler, const linear::EventLoop& loop);
+  /**
+   * Constructor
+   * @param [in] handler application defined behavior.
+   * @param [in] request_context common linear::WSRequestContext object
+   * @param [in] ssl_context common linear::SSLContext object
+   * @param [in] pool eventloop(thread) pool object, sockets are spread over loops of the pool
+   */
+  WSSClient(const linear::shared_ptr<linear::Handler>& handler,
+            const linear::WSRequestContext& request_context,
+            const linear::SSLContext& ssl_context,
+            const linear::EventLoopPool& pool);
   /**
    * Set common linear::WSRequestContext into Client Object.
    * If you can not provide linear::WSRequestContext when construct WSSClient, call this method.
@@ -69,6 +69,14 @@ class LINEAR_EXTERN WSSServer : public Server {
    * @see linear::AuthContext
    */
   void UseAuthentication(linear::AuthContext::Type auth_type, const std::string& realm);
+  /**
+   * Use stateless nonces for Digest Authentication.
+   * nonces are validated by HMAC and timestamp instead of being kept with a timer each until used.
+   * default is false.
+   * @param [in] use true to use stateless nonces
+   * @see linear::AuthContext
+   */
+  void UseStatelessNonce(bool use);
 };
 
 }  // namespace linear
@@ -0,0 +1,487 @@
+// linear micro benchmarks
+
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "linear/condition_variable.h"
+#include "linear/group.h"
+#include "linear/message.h"
+#include "linear/tcp_client.h"
+#include "linear/tcp_server.h"
+#include "linear/ws_client.h"
+#include "linear/ws_server.h"
+
+#include "message_decoder.h"
+#include "nonce_pool.h"
+#include "stateless_nonce.h"
+
+#define DEFAULT_TRY_NUM (100000)
+#define DEFAULT_MSIZ (64 * 1024)
+#define DEFAULT_PORT (10000)
+#define SCALE_DEPTH (16)
+#define GROUPS_SOCKETS (10000)
+#define GROUPS_PER_SOCKET (4)
+#define STORM_NONCES (50000)
+#define HANDSHAKES (1000)
+
+static uint64_t Now() {
+  struct timeval t;
+  gettimeofday(&t, NULL);
+  return static_cast<uint64_t>(t.tv_sec) * 1000 * 1000 * 1000 + static_cast<uint64_t>(t.tv_usec) * 1000;
+}
+
+static void ShowResult(const std::string& name, size_t num, uint64_t elapsed) {
+  std::cout << name << ": " << static_cast<double>(elapsed) / num << "ns/msg" << std::endl;
+}
+
+namespace decode {
+
+// params like [int, string, [int, int], {string: string}]
+static linear::type::any CreateParams(size_t msiz) {
+  std::vector<linear::type::any> params;
+  params.push_back(1);
+  params.push_back(std::string(msiz, 'a'));
+  std::vector<int> array;
+  array.push_back(2);
+  array.push_back(3);
+  params.push_back(array);
+  std::map<std::string, std::string> map;
+  map.insert(std::make_pair(std::string("key"), std::string("value")));
+  params.push_back(map);
+  return params;
+}
+
+// convert twice by Message and Request as linear did
+static void TwoPass(const msgpack::sbuffer& buffer, size_t num) {
+  uint64_t start = Now();
+  for (size_t i = 0; i < num; i++) {
+    size_t offset = 0;
+    msgpack::object_handle handle;
+    msgpack::unpack(handle, buffer.data(), buffer.size(), offset);
+    msgpack::object obj = handle.get();
+    linear::Message message = obj.as<linear::Message>();
+    if (message.type != linear::REQUEST) {
+      std::cerr << "invalid message" << std::endl;
+      return;
+    }
+    linear::Request request = obj.as<linear::Request>();
+  }
+  ShowResult("  two pass   ", num, Now() - start);
+}
+
+// check type once and adopt zone to params
+static void OnePass(const msgpack::sbuffer& buffer, size_t num) {
+  uint64_t start = Now();
+  for (size_t i = 0; i < num; i++) {
+    size_t offset = 0;
+    msgpack::object_handle handle;
+    msgpack::unpack(handle, buffer.data(), buffer.size(), offset);
+    if (linear::MessageDecoder::GetType(handle.get()) != linear::REQUEST) {
+      std::cerr << "invalid message" << std::endl;
+      return;
+    }
+    linear::Request request;
+    linear::MessageDecoder::Decode(handle, &request);
+  }
+  ShowResult("  single pass", num, Now() - start);
+}
+
+static void Run(size_t num, size_t msiz) {
+  size_t sizes[] = { 8, msiz };
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    linear::Request request("bench", CreateParams(sizes[i]));
+    msgpack::sbuffer buffer;
+    msgpack::pack(buffer, request);
+    std::cout << "decode request(" << buffer.size() << "bytes)" << std::endl;
+    TwoPass(buffer, num);
+    OnePass(buffer, num);
+  }
+}
+
+}  // namespace decode
+
+// servers and clients on 1..N loops, each loop has its own listener and socket.
+// libtv binds inside tv_listen and cannot share a port by SO_REUSEPORT,
+// so each loop listens on its own port (port + i) instead.
+namespace scale {
+
+class Echo : public linear::Handler {
+ public:
+  Echo() {}
+  ~Echo() {}
+
+  void OnMessage(const linear::Socket& socket, const linear::Message& msg) {
+    if (msg.type == linear::REQUEST) {
+      const linear::Request& request = msg.as<linear::Request>();
+      linear::Response response(request.msgid, request.params);
+      response.Send(socket);
+    }
+  }
+};
+
+class Sender : public linear::Handler {
+ public:
+  Sender(size_t num) : num_(num), sent_(0), recv_(0), done_(false) {}
+  ~Sender() {}
+
+  void OnConnect(const linear::Socket& socket) {
+    for (size_t i = 0; i < SCALE_DEPTH; i++) {
+      SendRequest(socket);
+    }
+  }
+  void OnDisconnect(const linear::Socket&, const linear::Error&) {
+    Done();
+  }
+  void OnMessage(const linear::Socket& socket, const linear::Message& msg) {
+    if (msg.type != linear::RESPONSE) {
+      return;
+    }
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    if (++recv_ == num_) {
+      lock.unlock();
+      Done();
+      return;
+    }
+    lock.unlock();
+    SendRequest(socket);
+  }
+  void OnError(const linear::Socket& socket, const linear::Message&, const linear::Error&) {
+    socket.Disconnect();
+  }
+  size_t WaitToFinish() {
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    while (!done_) {
+      cv_.wait(lock);
+    }
+    return recv_;
+  }
+
+ private:
+  void SendRequest(const linear::Socket& socket) {
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    if (sent_ >= num_) {
+      return;
+    }
+    sent_++;
+    lock.unlock();
+    linear::Request request("echo", std::string(128, 'a'));
+    request.Send(socket);
+  }
+  void Done() {
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    done_ = true;
+    cv_.notify_one();
+  }
+
+  size_t num_;
+  size_t sent_;
+  size_t recv_;
+  bool done_;
+  linear::mutex mutex_;
+  linear::condition_variable cv_;
+};
+
+static bool RunLoops(size_t loops, size_t num, int port) {
+  std::vector<linear::EventLoop> server_loops(loops), client_loops(loops);
+  std::vector<linear::TCPServer> servers;
+  std::vector<linear::TCPClient> clients;
+  std::vector<linear::TCPSocket> sockets;
+  std::vector<linear::shared_ptr<Sender> > senders;
+  linear::shared_ptr<Echo> echo(new Echo());
+  for (size_t i = 0; i < loops; i++) {
+    servers.push_back(linear::TCPServer(echo, server_loops[i]));
+    if (servers.back().Start("127.0.0.1", port + static_cast<int>(i)) != linear::Error(linear::LNR_OK)) {
+      std::cerr << "fail to start server at port " << port + i << std::endl;
+      return false;
+    }
+  }
+  uint64_t start = Now();
+  for (size_t i = 0; i < loops; i++) {
+    senders.push_back(linear::shared_ptr<Sender>(new Sender(num / loops)));
+    clients.push_back(linear::TCPClient(senders.back(), client_loops[i]));
+    sockets.push_back(clients.back().CreateSocket("127.0.0.1", port + static_cast<int>(i)));
+    sockets.back().Connect();
+  }
+  size_t total = 0;
+  for (size_t i = 0; i < loops; i++) {
+    total += senders[i]->WaitToFinish();
+  }
+  uint64_t elapsed = Now() - start;
+  for (size_t i = 0; i < loops; i++) {
+    sockets[i].Disconnect();
+    servers[i].Stop();
+  }
+  std::cout << "  loops = " << loops << ": " << total * 1000.0 * 1000.0 * 1000.0 / elapsed << "req/s" << std::endl;
+  return (total == (num / loops) * loops);
+}
+
+static void Run(size_t loops, size_t num, int port) {
+  std::cout << "echo throughput by loops (" << num << "requests, pipeline depth = " << SCALE_DEPTH << ")" << std::endl;
+  for (size_t i = 1; i <= loops; i++) {
+    if (!RunLoops(i, num, port)) {
+      std::cerr << "scale fail" << std::endl;
+      return;
+    }
+  }
+}
+
+}  // namespace scale
+
+// cost of Group::LeaveAll at disconnect against total number of groups.
+// each socket belongs to the broadcast group as sockets of servers do, and GROUPS_PER_SOCKET other groups.
+namespace groups {
+
+static void RunGroups(const std::vector<linear::TCPSocket>& sockets, size_t num_groups) {
+  std::vector<std::string> names(num_groups);
+  for (size_t i = 0; i < num_groups; i++) {
+    std::ostringstream name;
+    name << "group" << i;
+    names[i] = name.str();
+  }
+  uint64_t start = Now();
+  for (size_t i = 0; i < sockets.size(); i++) {
+    linear::Group::Join(LINEAR_BROADCAST_GROUP, sockets[i]);
+    for (size_t j = 0; j < GROUPS_PER_SOCKET; j++) {
+      linear::Group::Join(names[(i * GROUPS_PER_SOCKET + j) % num_groups], sockets[i]);
+    }
+  }
+  uint64_t joined = Now();
+  for (size_t i = 0; i < sockets.size(); i++) {
+    linear::Group::LeaveAll(sockets[i]);
+  }
+  uint64_t left = Now();
+  std::cout << "  groups = " << num_groups << ": join " << static_cast<double>(joined - start) / sockets.size()
+            << "ns/socket, leave all " << static_cast<double>(left - joined) / sockets.size()
+            << "ns/socket" << std::endl;
+}
+
+static void Run(size_t max_groups) {
+  linear::shared_ptr<linear::Handler> handler(new linear::Handler());
+  linear::TCPClient client(handler);
+  std::vector<linear::TCPSocket> sockets;
+  for (size_t i = 0; i < GROUPS_SOCKETS; i++) {
+    sockets.push_back(client.CreateSocket("127.0.0.1", DEFAULT_PORT));
+  }
+  std::cout << "group join / leave all by groups (" << GROUPS_SOCKETS << "sockets, "
+            << GROUPS_PER_SOCKET << "groups + broadcast per socket)" << std::endl;
+  for (size_t num_groups = 10; num_groups <= max_groups; num_groups *= 10) {
+    RunGroups(sockets, num_groups);
+  }
+}
+
+}  // namespace groups
+
+// cost of Digest nonces of WS servers, by NoncePool and StatelessNonce.
+// a reconnect storm issues STORM_NONCES nonces at once, then clients use them.
+// handshakes are sequential WS connects with Digest authentication, each of them issues and uses a nonce.
+namespace handshake {
+
+class Authorizer : public linear::Handler {
+ public:
+  Authorizer() {}
+  ~Authorizer() {}
+
+  void OnConnect(const linear::Socket& socket) {
+    linear::WSSocket ws = socket.as<linear::WSSocket>();
+    linear::AuthorizationContext auth = ws.GetWSRequestContext().authorization;
+    linear::WSResponseContext context;
+    context.code = (auth.Validate("password") == linear::AuthorizationContext::VALID) ?
+      LNR_WS_OK : LNR_WS_UNAUTHORIZED;
+    ws.SetWSResponseContext(context);
+  }
+};
+
+class Connector : public linear::Handler {
+ public:
+  Connector() : connected_(false), done_(false) {}
+  ~Connector() {}
+
+  void OnConnect(const linear::Socket& socket) {
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    connected_ = true;
+    lock.unlock();
+    socket.Disconnect();
+  }
+  void OnDisconnect(const linear::Socket&, const linear::Error&) {
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    done_ = true;
+    cv_.notify_one();
+  }
+  // return true if connected
+  bool WaitToFinish() {
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    while (!done_) {
+      cv_.wait(lock);
+    }
+    bool connected = connected_;
+    connected_ = done_ = false;
+    return connected;
+  }
+
+ private:
+  bool connected_;
+  bool done_;
+  linear::mutex mutex_;
+  linear::condition_variable cv_;
+};
+
+static void RunPool() {
+  linear::NoncePool pool;
+  std::vector<std::string> nonces(STORM_NONCES);
+  uint64_t start = Now();
+  for (size_t i = 0; i < nonces.size(); i++) {
+    linear::Error e;
+    do {
+      buffer b;
+      buffer_init(&b);
+      if (buffer_fill_random(&b, 24) < 0 || buffer_to_base64(&b) < 0) {
+        buffer_fin(&b);
+        std::cerr << "fail to create nonce" << std::endl;
+        return;
+      }
+      nonces[i] = std::string(b.ptr, b.len);
+      buffer_fin(&b);
+      e = pool.Add(nonces[i]);
+    } while (e == linear::Error(linear::LNR_EALREADY));
+  }
+  uint64_t issued = Now();
+  for (size_t i = 0; i < nonces.size(); i++) {
+    if (!pool.IsValid(nonces[i])) {
+      std::cerr << "invalid nonce" << std::endl;
+      return;
+    }
+    pool.Remove(nonces[i]);
+  }
+  uint64_t used = Now();
+  std::cout << "  pool     : issue " << static_cast<double>(issued - start) / nonces.size()
+            << "ns/nonce, use " << static_cast<double>(used - issued) / nonces.size() << "ns/nonce" << std::endl;
+}
+
+static void RunStateless() {
+  linear::StatelessNonce stateless;
+  std::vector<std::string> nonces(STORM_NONCES);
+  uint64_t start = Now();
+  for (size_t i = 0; i < nonces.size(); i++) {
+    if (stateless.Issue(&nonces[i]) != linear::Error(linear::LNR_OK)) {
+      std::cerr << "fail to create nonce" << std::endl;
+      return;
+    }
+  }
+  uint64_t issued = Now();
+  for (size_t i = 0; i < nonces.size(); i++) {
+    if (!stateless.Consume(nonces[i])) {
+      std::cerr << "invalid nonce" << std::endl;
+      return;
+    }
+  }
+  uint64_t used = Now();
+  std::cout << "  stateless: issue " << static_cast<double>(issued - start) / nonces.size()
+            << "ns/nonce, use " << static_cast<double>(used - issued) / nonces.size() << "ns/nonce" << std::endl;
+}
+
+static bool RunHandshakes(bool stateless, int port) {
+  linear::shared_ptr<Authorizer> authorizer(new Authorizer());
+  linear::WSServer server(authorizer, linear::AuthContext::DIGEST, "lbench");
+  server.UseStatelessNonce(stateless);
+  if (server.Start("127.0.0.1", port) != linear::Error(linear::LNR_OK)) {
+    std::cerr << "fail to start server at port " << port << std::endl;
+    return false;
+  }
+  linear::shared_ptr<Connector> connector(new Connector());
+  linear::WSClient client(connector);
+  linear::WSRequestContext context;
+  context.authenticate.type = linear::AuthContext::DIGEST;
+  context.authenticate.username = "user";
+  context.authenticate.password = "password";
+  linear::WSSocket socket = client.CreateSocket("127.0.0.1", port, context);
+  size_t connected = 0;
+  uint64_t start = Now();
+  for (size_t i = 0; i < HANDSHAKES; i++) {
+    if (socket.Connect() != linear::Error(linear::LNR_OK)) {
+      break;
+    }
+    if (connector->WaitToFinish()) {
+      connected++;
+    }
+  }
+  uint64_t elapsed = Now() - start;
+  server.Stop();
+  std::cout << "  " << (stateless ? "stateless" : "pool     ") << ": "
+            << connected * 1000.0 * 1000.0 * 1000.0 / elapsed << "handshakes/s" << std::endl;
+  return (connected == HANDSHAKES);
+}
+
+static void Run(int port) {
+  std::cout << "digest nonces in a reconnect storm (" << STORM_NONCES << "nonces)" << std::endl;
+  RunPool();
+  RunStateless();
+  std::cout << "ws handshakes with digest authentication (" << HANDSHAKES << "handshakes)" << std::endl;
+  if (!RunHandshakes(false, port) || !RunHandshakes(true, port)) {
+    std::cerr << "handshake fail" << std::endl;
+  }
+}
+
+}  // namespace handshake
+
+void usage(char* name) {
+  std::cout << "linear micro benchmarks." << std::endl << std::endl;
+  std::cout << "Usage: " << std::string(name) << " [options]" << std::endl;
+  std::cout << "[Options]" << std::endl;
+  std::cout << "  -c Loops: Run echo throughput by 1..Loops loops   default := off (decode only)" << std::endl;
+  std::cout << "            port 10000 .. 10000 + Loops - 1 are used" << std::endl;
+  std::cout << "  -g Grps : Run group leave all by 10..Grps groups  default := off (decode only)" << std::endl;
+  std::cout << "  -m Size : Set size of large params.               default := 65536bytes" << std::endl;
+  std::cout << "  -n Num  : Set num of try.                         default := 100000times" << std::endl;
+  std::cout << "  -w      : Run digest nonces and ws handshakes     default := off (decode only)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  int ch;
+  extern char* optarg;
+
+  size_t num = DEFAULT_TRY_NUM, msiz = DEFAULT_MSIZ, loops = 0, max_groups = 0;
+  bool handshakes = false;
+
+  while ((ch = getopt(argc, argv, "c:g:m:n:w")) != -1) {
+    switch(ch) {
+    case 'c':
+      loops = atoi(optarg);
+      break;
+    case 'g':
+      max_groups = atoi(optarg);
+      break;
+    case 'm':
+      msiz = atoi(optarg);
+      msiz = (msiz <= 0) ? DEFAULT_MSIZ : msiz;
+      break;
+    case 'n':
+      num = atoi(optarg);
+      num = (num <= 0) ? DEFAULT_TRY_NUM : num;
+      break;
+    case 'w':
+      handshakes = true;
+      break;
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+
+  if (loops > 0) {
+    scale::Run(loops, num, DEFAULT_PORT);
+  } else if (max_groups > 0) {
+    groups::Run(max_groups);
+  } else if (handshakes) {
+    handshake::Run(DEFAULT_PORT);
+  } else {
+    decode::Run(num, msiz);
+  }
+  return 0;
+}
@@ -7,22 +7,33 @@
 #include <string>
 #include <algorithm>
 #include <numeric>
+#include <map>
 
 #include "linear/condition_variable.h"
+#include "linear/dispatcher.h"
 #include "linear/tcp_server.h"
 #include "linear/tcp_client.h"
 #include "linear/log.h"
 
 #define DEFAULT_TRY_NUM (1000)
 #define DEFAULT_MSIZ (128)
+#define DEFAULT_DEPTH (1)
 
 using namespace linear::log;
 
 namespace receiver {
 
-class Handler : public linear::Handler {
+static void Echo(const linear::Socket& socket, const linear::Request& request) {
+  linear::Response response(request.msgid, request.params);
+  response.Send(socket);
+}
+
+class Handler : public linear::Dispatcher {
  public:
-  Handler() {}
+  Handler() {
+    RegisterRequest("echo", Echo);
+    Seal();
+  }
   ~Handler() {}
 
   void OnConnect(const linear::Socket&) {
@@ -33,26 +44,10 @@ class Handler : public linear::Handler {
     linear::unique_lock<linear::mutex> lock(mutex_);
     cv_.notify_one();
   }
-  void OnMessage(const linear::Socket& socket, const linear::Message& msg) {
-    switch(msg.type) {
-    case linear::REQUEST:
-      {
-        const linear::Request& request = msg.as<linear::Request>();
-        if (request.method == "echo") {
-          linear::Response response(request.msgid, request.params);
-          response.Send(socket);
-        } else {
-          linear::Response response(request.msgid, linear::type::nil(), std::string("invalid method"));
-          response.Send(socket);
-        }
-        break;
-      }
-    case linear::NOTIFY:
-    case linear::RESPONSE:
-    default:
-      {
-        break;
-      }
+  void OnUnhandledMessage(const linear::Socket& socket, const linear::Message& msg) {
+    if (msg.type == linear::REQUEST) {
+      linear::Response response(msg.as<linear::Request>().msgid, linear::type::nil(), std::string("invalid method"));
+      response.Send(socket);
     }
   }
   void WaitToFinish() {
@@ -71,15 +66,18 @@ namespace sender {
 
 class Handler : public linear::Handler {
  public:
-  Handler(size_t num, size_t msiz) : num_(num), msiz_(msiz) {}
+  Handler(size_t num, size_t msiz, size_t depth)
+    : num_(num), sent_(0), msiz_(msiz), depth_(depth) {}
   ~Handler() {}
 
   void OnConnect(const linear::Socket& socket) {
-    gettimeofday(&prev_, NULL);
-    linear::Request request("echo", std::string(msiz_, 'a'));
-    linear::Error e = request.Send(socket);
-    if (e.Code() != linear::LNR_OK) {
-      socket.Disconnect();
+    gettimeofday(&start_, NULL);
+    // keep 'depth' requests outstanding
+    for (size_t i = 0; i < depth_ && sent_ < num_; i++) {
+      if (!SendRequest(socket)) {
+        socket.Disconnect();
+        return;
+      }
     }
   }
   void OnDisconnect(const linear::Socket&, const linear::Error&) {
@@ -90,22 +88,26 @@ class Handler : public linear::Handler {
     switch(msg.type) {
     case linear::RESPONSE:
       {
-        linear::Response response = msg.as<linear::Response>();
+        const linear::Response& response = msg.as<linear::Response>();
         struct timeval t;
         gettimeofday(&t, NULL);
-        uint64_t d = (t.tv_sec - prev_.tv_sec) * 1000 * 1000 + (t.tv_usec - prev_.tv_usec);
+        linear::unique_lock<linear::mutex> lock(mutex_);
+        std::map<uint32_t, struct timeval>::iterator it = sent_at_.find(response.msgid);
+        if (it == sent_at_.end()) {
+          break;
+        }
+        uint64_t d = (t.tv_sec - it->second.tv_sec) * 1000 * 1000 + (t.tv_usec - it->second.tv_usec);
+        sent_at_.erase(it);
         duration_.push_back(d);
-        prev_ = t;
-        num_--;
-        if (num_ == 0) {
+        finish_ = t;
+        if (duration_.size() == num_) {
+          lock.unlock();
           socket.Disconnect();
           return;
         }
-        linear::Request request("echo", std::string(msiz_, 'a'));
-        linear::Error e = request.Send(socket);
-        if (e.Code() != linear::LNR_OK) {
-          linear::unique_lock<linear::mutex> lock(mutex_);
-          cv_.notify_one();
+        lock.unlock();
+        if (sent_ < num_ && !SendRequest(socket)) {
+          socket.Disconnect();
           return;
         }
         break;
@@ -125,7 +127,7 @@ class Handler : public linear::Handler {
   bool WaitToFinish() {
     linear::unique_lock<linear::mutex> lock(mutex_);
     cv_.wait(lock);
-    return (num_ == 0);
+    return (duration_.size() == num_);
   }
   void ShowResult() {
     uint64_t max = *(duration_.begin()), min = *(duration_.begin()), ave;
@@ -133,21 +135,43 @@ class Handler : public linear::Handler {
       min = (*it < min) ? *it : min;
       max = (max > *it) ? max : *it;
     }
-    ave = std::accumulate(duration_.begin(), duration_.end(), 0) / duration_.size();
+    ave = std::accumulate(duration_.begin(), duration_.end(), static_cast<uint64_t>(0)) / duration_.size();
+    std::sort(duration_.begin(), duration_.end());
     size_t midIndex = duration_.size() / 2;
-    std::nth_element(duration_.begin(), duration_.end() + midIndex, duration_.end());
+    size_t p99Index = duration_.size() * 99 / 100;
+    uint64_t elapsed = (finish_.tv_sec - start_.tv_sec) * 1000 * 1000 + (finish_.tv_usec - start_.tv_usec);
     std::cout << "--- Result ---" << std::endl;
     std::cout << "success: " << duration_.size() << ", RTT => "
               << "min: " << min / 1000.0 << "ms, "
               << "max: " << max / 1000.0 << "ms, "
               << "ave: " << ave / 1000.0 << "ms, "
-              << "med: " << duration_[midIndex] / 1000.0 << "ms" << std::endl;
+              << "med: " << duration_[midIndex] / 1000.0 << "ms, "
+              << "p99: " << duration_[p99Index] / 1000.0 << "ms" << std::endl;
+    if (elapsed > 0) {
+      std::cout << "throughput: " << duration_.size() * 1000.0 * 1000.0 / elapsed << "req/s" << std::endl;
+    }
   }
 
  private:
+  bool SendRequest(const linear::Socket& socket) {
+    linear::Request request("echo", std::string(msiz_, 'a'));
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    sent_at_[request.msgid] = t;
+    sent_++;
+    lock.unlock();
+    linear::Error e = request.Send(socket);
+    return (e.Code() == linear::LNR_OK);
+  }
+
   size_t num_;
+  size_t sent_;
   size_t msiz_;
-  struct timeval prev_;
+  size_t depth_;
+  struct timeval start_;
+  struct timeval finish_;
+  std::map<uint32_t, struct timeval> sent_at_;
   std::vector<uint64_t> duration_;
   linear::mutex mutex_;
   linear::condition_variable cv_;
@@ -168,6 +192,7 @@ void usage(char* name) {
   std::cout << "[Sender option]" << std::endl;
   std::cout << "  -m Size : Set message size.                       default := 128bytes" << std::endl;
   std::cout << "  -n Num  : Set num of try.                         default := 1000times" << std::endl;
+  std::cout << "  -p Depth: Set num of outstanding requests.        default := 1" << std::endl;
   std::cout << "[Debug option]" << std::endl;
   std::cout << "  -l Level: Show log.                               default := off" << std::endl;
   std::cout << "            ERR = 0, WARN = 1, INFO = 2, DEBUG = 3, FULL = 4" << std::endl;
@@ -192,10 +217,10 @@ int main(int argc, char* argv[]) {
   char t = '\0';
   NodeType type = UNDEFINED;
   NodeMode mode = SENDER;
-  size_t num = DEFAULT_TRY_NUM, msiz = DEFAULT_MSIZ;
+  size_t num = DEFAULT_TRY_NUM, msiz = DEFAULT_MSIZ, depth = DEFAULT_DEPTH;
   linear::log::Level level = linear::log::LOG_OFF;
 
-  while ((ch = getopt(argc, argv, "c:l:m:n:s:")) != -1) {
+  while ((ch = getopt(argc, argv, "c:l:m:n:p:s:")) != -1) {
     switch(ch) {
     case 'c':
       type = CLIENT;
@@ -215,6 +240,10 @@ int main(int argc, char* argv[]) {
       num = atoi(optarg);
       num = (num <= 0) ? DEFAULT_TRY_NUM : num;
       break;
+    case 'p':
+      depth = atoi(optarg);
+      depth = (depth <= 0) ? DEFAULT_DEPTH : depth;
+      break;
     case 's':
       type = SERVER;
       t = *optarg;
@@ -276,8 +305,9 @@ int main(int argc, char* argv[]) {
         std::cout << "Run as a client to send a request" << std::endl;
         std::cout << "--- Conditions ---" << std::endl;
         std::cout << "Target: " << host << ":" << port
-                  << ", Num of try: " << num << ", Message size: " << msiz << "bytes" << std::endl;
-        linear::shared_ptr<sender::Handler> h = linear::shared_ptr<sender::Handler>(new sender::Handler(num, msiz));
+                  << ", Num of try: " << num << ", Message size: " << msiz << "bytes"
+                  << ", Pipeline depth: " << depth << std::endl;
+        linear::shared_ptr<sender::Handler> h = linear::shared_ptr<sender::Handler>(new sender::Handler(num, msiz, depth));
         linear::TCPClient c(h);
         linear::TCPSocket s = c.CreateSocket(host, port);
         s.Connect();
@@ -310,8 +340,9 @@ int main(int argc, char* argv[]) {
         std::cout << "Run as a server to send a request" << std::endl;
         std::cout << "--- Conditions ---" << std::endl;
         std::cout << "Server started: " << host << ":" << port
-                  << ", Num of try: " << num << ", Message size: " << msiz << "bytes" << std::endl;
-        linear::shared_ptr<sender::Handler> h = linear::shared_ptr<sender::Handler>(new sender::Handler(num, msiz));
+                  << ", Num of try: " << num << ", Message size: " << msiz << "bytes"
+                  << ", Pipeline depth: " << depth << std::endl;
+        linear::shared_ptr<sender::Handler> h = linear::shared_ptr<sender::Handler>(new sender::Handler(num, msiz, depth));
         linear::TCPServer s(h);
         s.Start(host, port);
         if (h->WaitToFinish()) {
@@ -0,0 +1,62 @@
+#ifndef LINEAR_ATOMIC_H_
+#define LINEAR_ATOMIC_H_
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+namespace linear {
+
+// Atomic holds an integral or enum value that is read and updated without locks.
+// std::atomic is not available in C++03, so this wraps compiler builtins of a long value.
+// All operations are sequentially consistent.
+template <typename T>
+class Atomic {
+ public:
+  explicit Atomic(T value = T()) : value_(static_cast<long>(value)) {}
+  ~Atomic() {}
+
+  T Load() const {
+#ifdef _MSC_VER
+    return static_cast<T>(_InterlockedCompareExchange(const_cast<volatile long*>(&value_), 0, 0));
+#else
+    return static_cast<T>(__atomic_load_n(&value_, __ATOMIC_SEQ_CST));
+#endif
+  }
+  void Store(T value) {
+#ifdef _MSC_VER
+    _InterlockedExchange(&value_, static_cast<long>(value));
+#else
+    __atomic_store_n(&value_, static_cast<long>(value), __ATOMIC_SEQ_CST);
+#endif
+  }
+  // set desired and return true if the value is expected, or return false
+  bool CompareExchange(T expected, T desired) {
+#ifdef _MSC_VER
+    return (_InterlockedCompareExchange(&value_, static_cast<long>(desired), static_cast<long>(expected)) ==
+            static_cast<long>(expected));
+#else
+    long e = static_cast<long>(expected);
+    return __atomic_compare_exchange_n(&value_, &e, static_cast<long>(desired), false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+  }
+  // add delta and return the new value
+  T Add(long delta) {
+#ifdef _MSC_VER
+    return static_cast<T>(_InterlockedExchangeAdd(&value_, delta) + delta);
+#else
+    return static_cast<T>(__atomic_add_fetch(&value_, delta, __ATOMIC_SEQ_CST));
+#endif
+  }
+
+ private:
+  Atomic(const Atomic&);
+  Atomic& operator=(const Atomic&);
+
+  volatile long value_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_ATOMIC_H_
@@ -0,0 +1,15 @@
+#include "linear/client.h"
+
+#include "client_impl.h"
+
+namespace linear {
+
+Error Client::SetExecutor(const Executor& executor) const {
+  if (!client_) {
+    return Error(LNR_EINVAL);
+  }
+  client_->SetExecutor(executor.GetImpl());
+  return Error(LNR_OK);
+}
+
+}  // namespace linear
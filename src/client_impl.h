@@ -1,6 +1,7 @@
 #ifndef LINEAR_CLIENT_IMPL_H_
 #define LINEAR_CLIENT_IMPL_H_
 
+#include "event_loop_pool_impl.h"
 #include "handler_delegate.h"
 
 namespace linear {
@@ -12,6 +13,19 @@ class ClientImpl : public HandlerDelegate {
              bool show_ssl_version = false)
     : HandlerDelegate(handler, loop, show_ssl_version) {}
   virtual ~ClientImpl() {}
+  // sockets created after calling are spread over loops of the pool
+  void SetEventLoopPool(const linear::shared_ptr<linear::EventLoopPoolImpl>& pool) {
+    loop_pool_ = pool;
+  }
+
+ protected:
+  // event loop for a new socket
+  const linear::shared_ptr<linear::EventLoopImpl> NextLoop() {
+    return (loop_pool_) ? loop_pool_->Next() : loop_;
+  }
+
+ private:
+  linear::shared_ptr<linear::EventLoopPoolImpl> loop_pool_;
 };
 
 }
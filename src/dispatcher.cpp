@@ -0,0 +1,88 @@
+#include "linear/dispatcher.h"
+#include "linear/log.h"
+
+#include "method_table.h"
+
+using namespace linear::log;
+
+namespace linear {
+
+class DispatcherImpl {
+ public:
+  typedef MethodTable<shared_ptr<Dispatcher::ICallbackHolder> > Table;
+
+  DispatcherImpl() {}
+  ~DispatcherImpl() {}
+
+  Table& GetTable(message_type_t type) {
+    return (type == REQUEST) ? requests_ : notifies_;
+  }
+
+ private:
+  Table requests_;
+  Table notifies_;
+};
+
+Dispatcher::Dispatcher() : Handler(), impl_(new DispatcherImpl()) {
+}
+
+Dispatcher::~Dispatcher() {
+}
+
+Error Dispatcher::Register(message_type_t type, const std::string& method,
+                           const shared_ptr<ICallbackHolder>& holder) {
+  DispatcherImpl::Table& table = impl_->GetTable(type);
+  if (table.sealed()) {
+    return Error(LNR_EALREADY);
+  }
+  try {
+    if (!table.Insert(method, holder)) {
+      return Error(LNR_EEXIST);
+    }
+  } catch(...) {
+    return Error(LNR_ENOMEM);
+  }
+  return Error(LNR_OK);
+}
+
+Error Dispatcher::Seal() {
+  try {
+    impl_->GetTable(REQUEST).Seal();
+    impl_->GetTable(NOTIFY).Seal();
+  } catch(...) {
+    return Error(LNR_ENOMEM);
+  }
+  return Error(LNR_OK);
+}
+
+void Dispatcher::OnMessage(const Socket& socket, const Message& message) {
+  const shared_ptr<ICallbackHolder>* holder = NULL;
+  switch (message.type) {
+  case REQUEST:
+    holder = impl_->GetTable(REQUEST).Find(message.as<Request>().method);
+    break;
+  case NOTIFY:
+    holder = impl_->GetTable(NOTIFY).Find(message.as<Notify>().method);
+    break;
+  default:
+    break;
+  }
+  if (holder == NULL) {
+    OnUnhandledMessage(socket, message);
+    return;
+  }
+  (*holder)->Fire(socket, message);
+}
+
+void Dispatcher::OnUnhandledMessage(const Socket& socket, const Message& message) {
+  if (message.type == REQUEST) {
+    const Request& request = message.as<Request>();
+    LINEAR_LOG(LOG_WARN, "method not found: %s", request.method.c_str());
+    Response response(request.msgid, type::nil(), std::string("method not found"));
+    response.Send(socket);
+  } else if (message.type == NOTIFY) {
+    LINEAR_LOG(LOG_DEBUG, "method not found: %s", message.as<Notify>().method.c_str());
+  }
+}
+
+}  // namespace linear
@@ -1,14 +1,25 @@
 #include <cstdlib>
 
 #include "server_impl.h"
+#include "thread_context.h"
 #include "timer_impl.h"
+#include "timing_wheel.h"
 
 using namespace linear::log;
 
 namespace linear {
 
+uv_once_t ThreadContext::once_ = UV_ONCE_INIT;
+uv_key_t ThreadContext::key_;
+
+// handlers may be called in any callback from the loop, so mark the thread at the entry of them
+static inline void EnterLoop(tv_loop_t* loop) {
+  ThreadContext::Get()->SetLoop(loop);
+}
+
 void EventLoopImpl::OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, int status) {
   assert(srv_stream != NULL && srv_stream->data != NULL);
+  EnterLoop(srv_stream->loop);
   ServerEvent* ev = static_cast<ServerEvent*>(srv_stream->data);
   if (linear::shared_ptr<ServerImpl> server = ev->server.lock()) {
     server->OnAccept(srv_stream, cli_stream, status);
@@ -17,6 +28,7 @@ void EventLoopImpl::OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, i
 
 void EventLoopImpl::OnAcceptComplete(tv_stream_t* stream, int status) {
   assert(stream != NULL && stream->data != NULL);
+  EnterLoop(stream->loop);
   SocketEvent* ev = static_cast<SocketEvent*>(stream->data);
   if (linear::shared_ptr<SocketImpl> socket = ev->socket.lock()) {
     socket->OnHandshakeComplete(socket, stream, status);
@@ -25,6 +37,7 @@ void EventLoopImpl::OnAcceptComplete(tv_stream_t* stream, int status) {
 
 void EventLoopImpl::OnConnect(tv_stream_t* stream, int status) {
   assert(stream != NULL && stream->data != NULL);
+  EnterLoop(stream->loop);
   SocketEvent* ev = static_cast<SocketEvent*>(stream->data);
   if (linear::shared_ptr<SocketImpl> socket = ev->socket.lock()) {
     socket->OnConnect(socket, stream, status);
@@ -33,6 +46,7 @@ void EventLoopImpl::OnConnect(tv_stream_t* stream, int status) {
 
 void EventLoopImpl::OnClose(tv_handle_t* handle) {
   assert(handle != NULL && handle->data != NULL);
+  EnterLoop(handle->loop);
   switch (static_cast<Event*>(handle->data)->type) {
   case SERVER:
     {
@@ -55,6 +69,12 @@ void EventLoopImpl::OnClose(tv_handle_t* handle) {
       delete ev;
     }
     break;
+  case TIMING_WHEEL:
+    {
+      TimingWheelEvent* ev = static_cast<TimingWheelEvent*>(handle->data);
+      delete ev;
+    }
+    break;
   default:
     LINEAR_LOG(LOG_ERR, "BUG: invalid type of event");
     assert(false);
@@ -62,8 +82,16 @@ void EventLoopImpl::OnClose(tv_handle_t* handle) {
   free(handle);
 }
 
+// close a stream that is rejected at accept, before any socket or event is built for it
+void EventLoopImpl::OnReject(tv_handle_t* handle) {
+  assert(handle != NULL);
+  EnterLoop(handle->loop);
+  free(handle);
+}
+
 void EventLoopImpl::OnRead(tv_stream_t* stream, ssize_t nread, const tv_buf_t* buffer) {
   assert(stream != NULL && stream->data != NULL && buffer != NULL);
+  EnterLoop(stream->loop);
   SocketEvent* ev = static_cast<SocketEvent*>(stream->data);
   if (linear::shared_ptr<SocketImpl> socket = ev->socket.lock()) {
     socket->OnRead(socket, buffer, nread);
@@ -74,24 +102,33 @@ void EventLoopImpl::OnWrite(tv_write_t* request, int status) {
   assert(request != NULL && request->data != NULL &&
          request->handle != NULL && request->handle->data != NULL &&
          request->buf.base != NULL);
-  Message* message = static_cast<Message*>(request->data);
+  EnterLoop(request->handle->loop);
+  WriteBuffer* buffer = static_cast<WriteBuffer*>(request->data);
   SocketEvent* ev = static_cast<SocketEvent*>(request->handle->data);
   if (linear::shared_ptr<SocketImpl> socket = ev->socket.lock()) {
-    socket->OnWrite(socket, message, status);
+    socket->OnWrite(socket, buffer, status);
   }
-  delete message;
-  free(request->buf.base);
-  free(request);
+  buffer->pool->Release(buffer);
 }
 
 void EventLoopImpl::OnTimer(tv_timer_t* handle) {
   assert(handle != NULL && handle->data != NULL);
+  EnterLoop(handle->loop);
   TimerEvent* ev = static_cast<TimerEvent*>(handle->data);
   if (linear::shared_ptr<TimerImpl> timer = ev->timer.lock()) {
     timer->OnTimer();
   }
 }
 
+void EventLoopImpl::OnTick(tv_timer_t* handle) {
+  assert(handle != NULL && handle->data != NULL);
+  EnterLoop(handle->loop);
+  TimingWheelEvent* ev = static_cast<TimingWheelEvent*>(handle->data);
+  if (linear::shared_ptr<TimingWheel> wheel = ev->wheel.lock()) {
+    wheel->OnTick();
+  }
+}
+
 void EventLoopImpl::OnConnectTimeout(void* args) {
   assert(args != NULL);
   SocketEvent* ev = static_cast<SocketEvent*>(args);
@@ -100,28 +137,44 @@ void EventLoopImpl::OnConnectTimeout(void* args) {
   }
 }
 
+void EventLoopImpl::OnFlushTimeout(void* args) {
+  assert(args != NULL);
+  SocketEvent* ev = static_cast<SocketEvent*>(args);
+  if (linear::shared_ptr<SocketImpl> socket = ev->socket.lock()) {
+    socket->OnFlushTimeout(socket);
+  }
+}
+
 void EventLoopImpl::OnRequestTimeout(void* args) {
   assert(args != NULL);
   SocketImpl::RequestTimer* request_timer = static_cast<SocketImpl::RequestTimer*>(args);
+  // deleted by socket if it is still pending.
+  // if the socket is being destroyed, its destructor cancels and deletes request_timer
+  // after this callback returns
   if (linear::shared_ptr<SocketImpl> socket = request_timer->socket.lock()) {
-    socket->OnRequestTimeout(socket, request_timer->request);
+    socket->OnRequestTimeout(socket, request_timer);
   }
-  delete request_timer;
 }
 
-EventLoopImpl::EventLoopImpl() : handle_(tv_loop_new()) {
+EventLoopImpl::EventLoopImpl()
+  : handle_(tv_loop_new()), timing_wheel_(new TimingWheel(handle_)), num_of_sockets_(0) {
   assert(handle_ != NULL);
+  timing_wheel_->SetEvent(new TimingWheelEvent(timing_wheel_));
 }
 
-EventLoopImpl::EventLoopImpl(const EventLoopImpl& loop) : handle_(loop.handle_) {
+EventLoopImpl::EventLoopImpl(const EventLoopImpl& loop)
+  : handle_(loop.handle_), timing_wheel_(loop.timing_wheel_), num_of_sockets_(0) {
 }
 
 EventLoopImpl& EventLoopImpl::operator=(const EventLoopImpl& loop) {
   handle_ = loop.handle_;
+  timing_wheel_ = loop.timing_wheel_;
   return *this;
 }
 
 EventLoopImpl::~EventLoopImpl() {
+  // tv_timer of timing wheel must be closed before the loop
+  timing_wheel_.reset();
   tv_loop_delete(handle_);
 }
 
@@ -129,4 +182,28 @@ tv_loop_t* EventLoopImpl::GetHandle() const {
   return handle_;
 }
 
+WriteBufferPool& EventLoopImpl::GetWriteBufferPool() {
+  return write_buffer_pool_;
+}
+
+const linear::shared_ptr<TimingWheel>& EventLoopImpl::GetTimingWheel() const {
+  return timing_wheel_;
+}
+
+void EventLoopImpl::IncreaseSockets() {
+  lock_guard<mutex> lock(sockets_mutex_);
+  num_of_sockets_++;
+}
+
+void EventLoopImpl::DecreaseSockets() {
+  lock_guard<mutex> lock(sockets_mutex_);
+  assert(num_of_sockets_ > 0);
+  num_of_sockets_--;
+}
+
+size_t EventLoopImpl::GetNumOfSockets() {
+  lock_guard<mutex> lock(sockets_mutex_);
+  return num_of_sockets_;
+}
+
 }  // namespace linear
@@ -9,12 +9,16 @@
 #include "tv.h"
 
 #include "linear/memory.h"
+#include "linear/mutex.h"
+
+#include "write_buffer.h"
 
 namespace linear {
 
 class ServerImpl;
 class SocketImpl;
 class TimerImpl;
+class TimingWheel;
 
 class EventLoopImpl {
  public:
@@ -22,6 +26,7 @@ class EventLoopImpl {
     SERVER,
     SOCKET,
     TIMER,
+    TIMING_WHEEL,
   };
   struct Event {
     Event(linear::EventLoopImpl::EventType t) : type(t) {}
@@ -43,6 +48,11 @@ class EventLoopImpl {
       : Event(linear::EventLoopImpl::TIMER), timer(t) {}
     linear::weak_ptr<linear::TimerImpl> timer;
   };
+  struct TimingWheelEvent : public Event {
+    TimingWheelEvent(const linear::shared_ptr<linear::TimingWheel>& w)
+      : Event(linear::EventLoopImpl::TIMING_WHEEL), wheel(w) {}
+    linear::weak_ptr<linear::TimingWheel> wheel;
+  };
 
  public:
   EventLoopImpl();
@@ -54,17 +64,30 @@ class EventLoopImpl {
   static void OnAcceptComplete(tv_stream_t* stream, int status);
   static void OnConnect(tv_stream_t* handle, int status);
   static void OnClose(tv_handle_t* handle);
+  static void OnReject(tv_handle_t* handle);
   static void OnRead(tv_stream_t* handle, ssize_t nread, const tv_buf_t* buf);
   static void OnWrite(tv_write_t* req, int status);
   static void OnTimer(tv_timer_t* tv_timer);
+  static void OnTick(tv_timer_t* tv_timer);
 
   static void OnConnectTimeout(void* args);
+  static void OnFlushTimeout(void* args);
   static void OnRequestTimeout(void* args);
 
   tv_loop_t* GetHandle() const;
+  linear::WriteBufferPool& GetWriteBufferPool();
+  const linear::shared_ptr<linear::TimingWheel>& GetTimingWheel() const;
+  // number of live SocketImpl objects on this loop
+  void IncreaseSockets();
+  void DecreaseSockets();
+  size_t GetNumOfSockets();
 
  private:
   tv_loop_t* handle_;
+  linear::WriteBufferPool write_buffer_pool_;
+  linear::shared_ptr<linear::TimingWheel> timing_wheel_;
+  size_t num_of_sockets_;
+  linear::mutex sockets_mutex_;
 };
 
 }  // namespace linear
@@ -0,0 +1,34 @@
+#include <stdexcept>
+
+#include "linear/log.h"
+
+#include "event_loop_pool_impl.h"
+
+using namespace linear::log;
+
+namespace linear {
+
+EventLoopPool::EventLoopPool(size_t size, EventLoopPool::Policy policy) {
+  if (size == 0) {
+    LINEAR_LOG(LOG_ERR, "size of event loop pool must be greater than 0");
+    throw std::invalid_argument("size of event loop pool must be greater than 0");
+  }
+  pool_ = shared_ptr<EventLoopPoolImpl>(new EventLoopPoolImpl(size, policy));
+}
+
+EventLoopPool::~EventLoopPool() {
+}
+
+size_t EventLoopPool::GetSize() const {
+  return pool_->GetSize();
+}
+
+const EventLoop& EventLoopPool::GetEventLoop(size_t index) const {
+  return pool_->GetEventLoop(index);
+}
+
+const shared_ptr<EventLoopPoolImpl> EventLoopPool::GetImpl() const {
+  return pool_;
+}
+
+}  // namespace linear
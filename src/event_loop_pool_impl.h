@@ -0,0 +1,68 @@
+/**
+ * @file event_loop_pool_impl.h
+ * Event loop pool class definition
+ */
+
+#ifndef LINEAR_EVENT_LOOP_POOL_IMPL_H_
+#define LINEAR_EVENT_LOOP_POOL_IMPL_H_
+
+#include <vector>
+
+#include "linear/event_loop_pool.h"
+#include "linear/mutex.h"
+
+#include "event_loop_impl.h"
+
+namespace linear {
+
+// EventLoopPoolImpl chooses an event loop for a new socket by linear::EventLoopPool::Policy.
+// LEAST_SOCKETS counts live SocketImpl objects of each loop, so the sockets accepted
+// by servers that share the loop are also counted.
+class EventLoopPoolImpl {
+ public:
+  EventLoopPoolImpl(size_t size, linear::EventLoopPool::Policy policy) : policy_(policy), next_(0) {
+    // each EventLoop() creates a new thread, so do not copy one EventLoop by vector(size)
+    loops_.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+      loops_.push_back(linear::EventLoop());
+    }
+  }
+  ~EventLoopPoolImpl() {}
+  size_t GetSize() const {
+    return loops_.size();
+  }
+  const linear::EventLoop& GetEventLoop(size_t index) const {
+    return loops_.at(index);
+  }
+  const linear::shared_ptr<linear::EventLoopImpl> Next() {
+    linear::lock_guard<linear::mutex> lock(mutex_);
+    size_t index = next_;
+    if (policy_ == linear::EventLoopPool::LEAST_SOCKETS) {
+      // start from next_ so that loops that have the same number of sockets are used in turn
+      size_t least = loops_[index].GetImpl()->GetNumOfSockets();
+      for (size_t i = 1; i < loops_.size() && least > 0; i++) {
+        size_t j = (next_ + i) % loops_.size();
+        size_t num = loops_[j].GetImpl()->GetNumOfSockets();
+        if (num < least) {
+          index = j;
+          least = num;
+        }
+      }
+    }
+    next_ = (index + 1) % loops_.size();
+    return loops_[index].GetImpl();
+  }
+
+ private:
+  EventLoopPoolImpl(const EventLoopPoolImpl&);
+  EventLoopPoolImpl& operator=(const EventLoopPoolImpl&);
+
+  std::vector<linear::EventLoop> loops_;
+  linear::EventLoopPool::Policy policy_;
+  size_t next_;
+  linear::mutex mutex_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_EVENT_LOOP_POOL_IMPL_H_
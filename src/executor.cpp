@@ -0,0 +1,34 @@
+#include <stdexcept>
+
+#include "linear/log.h"
+
+#include "executor_impl.h"
+
+using namespace linear::log;
+
+namespace linear {
+
+Executor::Executor(size_t num_of_threads, size_t max_queue_size) {
+  if (num_of_threads == 0) {
+    LINEAR_LOG(LOG_ERR, "number of worker threads must be greater than 0");
+    throw std::invalid_argument("number of worker threads must be greater than 0");
+  }
+  executor_ = shared_ptr<ExecutorImpl>(new ExecutorImpl(num_of_threads, max_queue_size));
+}
+
+Executor::~Executor() {
+}
+
+size_t Executor::GetNumOfThreads() const {
+  return executor_->GetNumOfThreads();
+}
+
+Executor::Stats Executor::GetStats() const {
+  return executor_->GetStats();
+}
+
+const shared_ptr<ExecutorImpl> Executor::GetImpl() const {
+  return executor_;
+}
+
+}  // namespace linear
@@ -0,0 +1,162 @@
+#include <cassert>
+#include <stdexcept>
+
+#include "linear/log.h"
+
+#include "executor_impl.h"
+
+using namespace linear::log;
+
+namespace linear {
+
+ExecutorImpl::ExecutorImpl(size_t num_of_threads, size_t max_queue_size)
+  : max_queue_size_(max_queue_size), counters_(new Counters()) {
+  workers_.reserve(num_of_threads);
+  threads_.reserve(num_of_threads);
+  for (size_t i = 0; i < num_of_threads; i++) {
+    shared_ptr<Worker> worker(new Worker());
+    Context* context = new Context(worker, counters_);
+    uv_thread_t thread;
+    int ret = uv_thread_create(&thread, ExecutorImpl::Run, context);
+    if (ret) {
+      delete context;
+      LINEAR_LOG(LOG_ERR, "fail to create worker thread: %s", uv_strerror(ret));
+      Shutdown();
+      throw std::runtime_error("fail to create worker thread");
+    }
+    workers_.push_back(worker);
+    threads_.push_back(thread);
+  }
+}
+
+ExecutorImpl::~ExecutorImpl() {
+  Shutdown();
+}
+
+void ExecutorImpl::Shutdown() {
+  // waiting tasks are executed before workers exit
+  for (std::vector<shared_ptr<Worker> >::iterator it = workers_.begin(); it != workers_.end(); it++) {
+    lock_guard<mutex> lock((*it)->mutex);
+    (*it)->stop = true;
+    (*it)->not_empty.notify_all();
+    (*it)->not_full.notify_all();
+  }
+  uv_thread_t self = uv_thread_self();
+  for (std::vector<uv_thread_t>::iterator it = threads_.begin(); it != threads_.end(); it++) {
+    // a worker cannot join itself, and exits after the current task by itself
+    if (!uv_thread_equal(&(*it), &self)) {
+      uv_thread_join(&(*it));
+    }
+  }
+  workers_.clear();
+  threads_.clear();
+}
+
+size_t ExecutorImpl::GetNumOfThreads() const {
+  return threads_.size();
+}
+
+Executor::Stats ExecutorImpl::GetStats() {
+  Executor::Stats stats;
+  stats.queued = 0;
+  for (std::vector<shared_ptr<Worker> >::iterator it = workers_.begin(); it != workers_.end(); it++) {
+    lock_guard<mutex> lock((*it)->mutex);
+    stats.queued += (*it)->tasks.size();
+  }
+  lock_guard<mutex> lock(counters_->mutex);
+  stats.max_queued = counters_->max_queued;
+  stats.executed = counters_->executed;
+  stats.dropped = counters_->dropped;
+  stats.total_wait = counters_->total_wait;
+  stats.max_wait = counters_->max_wait;
+  return stats;
+}
+
+bool ExecutorImpl::Post(size_t key, ExecutorImpl::Task* task, bool droppable) {
+  assert(task != NULL);
+  shared_ptr<Worker>& worker = workers_[key % workers_.size()];
+  bool blockable = !IsLoopThread() && !IsWorkerThread();
+  unique_lock<mutex> lock(worker->mutex);
+  while (blockable && max_queue_size_ > 0 && worker->tasks.size() >= max_queue_size_ && !worker->stop) {
+    worker->not_full.wait(lock);
+  }
+  if (worker->stop) {
+    lock.unlock();
+    delete task;
+    return false;
+  }
+  if (droppable && max_queue_size_ > 0 && worker->tasks.size() >= max_queue_size_) {
+    lock.unlock();
+    delete task;
+    lock_guard<mutex> counters_lock(counters_->mutex);
+    counters_->dropped++;
+    return false;
+  }
+  task->queued_at_ = uv_hrtime();
+  try {
+    worker->tasks.push_back(task);
+  } catch(...) {
+    lock.unlock();
+    LINEAR_LOG(LOG_ERR, "fail to post task: no memory");
+    delete task;
+    return false;
+  }
+  size_t queued = worker->tasks.size();
+  worker->not_empty.notify_one();
+  lock.unlock();
+
+  lock_guard<mutex> counters_lock(counters_->mutex);
+  if (counters_->max_queued < queued) {
+    counters_->max_queued = queued;
+  }
+  return true;
+}
+
+void ExecutorImpl::Run(void* args) {
+  Context* context = static_cast<Context*>(args);
+  shared_ptr<Worker> worker = context->worker;
+  shared_ptr<Counters> counters = context->counters;
+  delete context;
+
+  while (true) {
+    unique_lock<mutex> lock(worker->mutex);
+    while (worker->tasks.empty() && !worker->stop) {
+      worker->not_empty.wait(lock);
+    }
+    if (worker->tasks.empty()) {
+      break;
+    }
+    Task* task = worker->tasks.front();
+    worker->tasks.pop_front();
+    worker->not_full.notify_one();
+    lock.unlock();
+
+    uint64_t wait = (uv_hrtime() - task->queued_at_) / 1000;
+    unique_lock<mutex> counters_lock(counters->mutex);
+    counters->executed++;
+    counters->total_wait += wait;
+    if (counters->max_wait < wait) {
+      counters->max_wait = wait;
+    }
+    counters_lock.unlock();
+
+    try {
+      task->Run();
+    } catch(...) {
+      LINEAR_LOG(LOG_WARN, "something wrong at executor task");
+    }
+    delete task;
+  }
+}
+
+bool ExecutorImpl::IsWorkerThread() const {
+  uv_thread_t self = uv_thread_self();
+  for (std::vector<uv_thread_t>::const_iterator it = threads_.begin(); it != threads_.end(); it++) {
+    if (uv_thread_equal(&(*it), &self)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace linear
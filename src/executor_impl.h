@@ -0,0 +1,94 @@
+/**
+ * @file executor_impl.h
+ * Executor class definition
+ */
+
+#ifndef LINEAR_EXECUTOR_IMPL_H_
+#define LINEAR_EXECUTOR_IMPL_H_
+
+#include <deque>
+#include <vector>
+
+#include "tv.h"
+
+#include "linear/condition_variable.h"
+#include "linear/executor.h"
+
+#include "thread_context.h"
+
+namespace linear {
+
+// ExecutorImpl runs tasks on worker threads.
+// Each worker has its own serial queue, and tasks posted with the same key run on
+// the same worker in order.
+// Post blocks while the queue is full, except on event loop threads and worker threads.
+// - an event loop must not wait for a worker, that may wait for a response read by the loop
+// - a task that posts to its own full queue would never be able to finish
+// there a task is dropped if the queue is full, or queued over the limit if it must not be dropped.
+class ExecutorImpl {
+ public:
+  class Task {
+   public:
+    Task() : queued_at_(0) {}
+    virtual ~Task() {}
+    virtual void Run() = 0;
+
+   private:
+    friend class ExecutorImpl;
+    uint64_t queued_at_; // nsec
+  };
+
+ public:
+  ExecutorImpl(size_t num_of_threads, size_t max_queue_size);
+  ~ExecutorImpl();
+
+  size_t GetNumOfThreads() const;
+  linear::Executor::Stats GetStats();
+  // task is owned by ExecutorImpl, return false if dropped
+  bool Post(size_t key, linear::ExecutorImpl::Task* task, bool droppable = false);
+
+ private:
+  // shared with worker threads, and outlives ExecutorImpl if it is destroyed on a worker
+  struct Worker {
+    Worker() : stop(false) {}
+    std::deque<linear::ExecutorImpl::Task*> tasks;
+    bool stop;
+    linear::mutex mutex;
+    linear::condition_variable not_empty;
+    linear::condition_variable not_full;
+  };
+  struct Counters {
+    Counters() : max_queued(0), executed(0), dropped(0), total_wait(0), max_wait(0) {}
+    size_t max_queued;
+    uint64_t executed;
+    uint64_t dropped;
+    uint64_t total_wait; // usec
+    uint64_t max_wait;   // usec
+    linear::mutex mutex;
+  };
+  struct Context {
+    Context(const linear::shared_ptr<Worker>& w, const linear::shared_ptr<Counters>& c)
+      : worker(w), counters(c) {}
+    linear::shared_ptr<Worker> worker;
+    linear::shared_ptr<Counters> counters;
+  };
+
+  ExecutorImpl(const ExecutorImpl&);
+  ExecutorImpl& operator=(const ExecutorImpl&);
+
+  static void Run(void* args);
+  void Shutdown();
+  bool IsWorkerThread() const;
+  static bool IsLoopThread() {
+    return (linear::ThreadContext::Get()->GetLoop() != NULL);
+  }
+
+  size_t max_queue_size_;
+  std::vector<linear::shared_ptr<Worker> > workers_;
+  std::vector<uv_thread_t> threads_;
+  linear::shared_ptr<Counters> counters_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_EXECUTOR_IMPL_H_
@@ -0,0 +1,37 @@
+#include "linear/future.h"
+
+#include "future_impl.h"
+
+namespace linear {
+
+Future::Future(const shared_ptr<FutureImpl>& impl) : impl_(impl) {
+}
+
+Future::~Future() {
+}
+
+bool Future::IsReady() const {
+  return impl_->IsReady();
+}
+
+void Future::Wait() const {
+  impl_->Wait();
+}
+
+const Error& Future::GetError() const {
+  return impl_->GetError();
+}
+
+const Response& Future::GetResponse() const {
+  return impl_->GetResponse();
+}
+
+bool Future::OnReady(void (*callback)(void*), void* arg) const {
+  return impl_->OnReady(callback, arg);
+}
+
+const shared_ptr<FutureImpl> Future::GetImpl() const {
+  return impl_;
+}
+
+}  // namespace linear
@@ -0,0 +1,91 @@
+#ifndef LINEAR_FUTURE_IMPL_H_
+#define LINEAR_FUTURE_IMPL_H_
+
+#include <utility>
+#include <vector>
+
+#include "linear/message.h"
+#include "linear/mutex.h"
+
+#include "thread_context.h"
+
+namespace linear {
+
+// FutureImpl is the completion state of linear::Request.SendAsync, allocated once per call.
+// It is shared by the Future and the copy of the Request in the pending-request slot,
+// because the Future outlives the slot, and completing it needs no other allocation.
+// Waiters park on the event of their own ThreadContext instead of a condition variable per request.
+// Only the first completion takes effect, later ones (e.g. a write error after timeout) are ignored.
+// Callbacks registered by OnReady are called in order of registration.
+class FutureImpl {
+ public:
+  typedef void (*Callback)(void*);
+
+  FutureImpl() : ready_(false) {}
+  ~FutureImpl() {}
+
+  void Complete(const linear::Response& response, const linear::Error& error) {
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    if (ready_) {
+      return;
+    }
+    response_ = response;
+    error_ = error;
+    ready_ = true;
+    std::vector<std::pair<Callback, void*> > callbacks;
+    callbacks.swap(callbacks_);
+    std::vector<ThreadContext*> waiters;
+    waiters.swap(waiters_);
+    lock.unlock();
+    for (std::vector<ThreadContext*>::iterator it = waiters.begin(); it != waiters.end(); it++) {
+      (*it)->Post();
+    }
+    for (std::vector<std::pair<Callback, void*> >::iterator it = callbacks.begin(); it != callbacks.end(); it++) {
+      it->first(it->second);
+    }
+  }
+  bool IsReady() {
+    linear::lock_guard<linear::mutex> lock(mutex_);
+    return ready_;
+  }
+  void Wait() {
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    if (ready_) {
+      return;
+    }
+    ThreadContext* context = ThreadContext::Get();
+    waiters_.push_back(context);
+    lock.unlock();
+    // posted exactly once by Complete
+    context->Wait();
+  }
+  bool OnReady(Callback callback, void* arg) {
+    linear::lock_guard<linear::mutex> lock(mutex_);
+    if (ready_) {
+      return false;
+    }
+    callbacks_.push_back(std::make_pair(callback, arg));
+    return true;
+  }
+  // response_ and error_ are never changed after ready
+  const linear::Error& GetError() {
+    Wait();
+    return error_;
+  }
+  const linear::Response& GetResponse() {
+    Wait();
+    return response_;
+  }
+
+ private:
+  bool ready_;
+  linear::Response response_;
+  linear::Error error_;
+  std::vector<std::pair<Callback, void*> > callbacks_;
+  std::vector<ThreadContext*> waiters_;
+  linear::mutex mutex_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_FUTURE_IMPL_H_
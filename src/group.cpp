@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <map>
 
 #include "linear/mutex.h"
@@ -10,71 +11,200 @@ namespace linear {
 
 namespace group {
 
+typedef Group::Snapshot::Chunk Chunk;
+typedef Group::Snapshot::Chunks Chunks;
+
+// Pool keeps each group as an immutable snapshot, and replaces it on every change.
+// readers hold the shard lock only to copy the shared_ptr of a snapshot, and iterate it without lock.
+// a snapshot is a list of sorted chunks (at most MAX_CHUNK_SIZE sockets each, never empty),
+// so a change copies the list of pointers and only the chunk that has the socket,
+// even for the broadcast group that has all sockets of servers.
+// groups are sharded by hash of the name, so that Join/Leave of different groups rarely contend,
+// and groups of each socket are indexed by socket id, so that LeaveAll visits only them.
 class Pool {
  public:
+  static const size_t NUM_OF_SHARDS = 16;
+  static const size_t MAX_CHUNK_SIZE = 256;
+
   static Pool& GetInstance() {
     static Pool pool;
     return pool;
   }
-  Pool() : mutex_() {}
+  Pool() {}
   ~Pool() {}
   std::vector<std::string> Names() {
     std::vector<std::string> keys;
-    lock_guard<linear::mutex> lock(mutex_);
-
-    std::map<std::string, std::set<linear::Socket> >::iterator it = pool_.begin();
-    while(it != pool_.end()) {
-      keys.push_back(it->first);
-      ++it;
+    for (size_t i = 0; i < NUM_OF_SHARDS; i++) {
+      lock_guard<linear::mutex> lock(shards_[i].mutex);
+      std::map<std::string, Group::Snapshot>::iterator it = shards_[i].groups.begin();
+      while (it != shards_[i].groups.end()) {
+        keys.push_back(it->first);
+        ++it;
+      }
     }
     return keys;
   }
-  std::set<linear::Socket> Get(const std::string& name) {
-    lock_guard<linear::mutex> lock(mutex_);
-    std::map<std::string, std::set<linear::Socket> >::iterator it = pool_.find(name);
-    if (it != pool_.end()) {
+  Group::Snapshot Get(const std::string& name) {
+    Shard& shard = GetShard(name);
+    lock_guard<linear::mutex> lock(shard.mutex);
+    std::map<std::string, Group::Snapshot>::iterator it = shard.groups.find(name);
+    if (it != shard.groups.end()) {
       return it->second;
     } else {
-      return std::set<linear::Socket>();
+      return Group::Snapshot();
     }
   }
+  // the members lock is held across the change of the group, in the order of members then shard,
+  // so that the index never misses a group that has the socket
   void Join(const std::string& name, const linear::Socket& socket) {
-    lock_guard<linear::mutex> lock(mutex_);
+    Members& members = GetMembers(socket);
+    lock_guard<linear::mutex> members_lock(members.mutex);
+    Shard& shard = GetShard(name);
+    lock_guard<linear::mutex> lock(shard.mutex);
     LINEAR_LOG(LOG_DEBUG, "join socket(id = %d) into group_name = \"%s\"",
                socket.GetId(), name.c_str());
-    pool_[name].insert(socket);
+    if (Insert(&shard.groups[name], socket)) {
+      members.groups[socket.GetId()].insert(name);
+    }
   }
   void Leave(const std::string& name, const linear::Socket& socket) {
-    lock_guard<linear::mutex> lock(mutex_);
     LINEAR_LOG(LOG_DEBUG, "leave socket(id = %d) from group_name = \"%s\"",
                socket.GetId(), name.c_str());
-    pool_[name].erase(socket);
+    Members& members = GetMembers(socket);
+    lock_guard<linear::mutex> members_lock(members.mutex);
+    if (!Remove(name, socket)) {
+      return;
+    }
+    std::map<int, std::set<std::string> >::iterator it = members.groups.find(socket.GetId());
+    if (it != members.groups.end()) {
+      it->second.erase(name);
+      if (it->second.empty()) {
+        members.groups.erase(it);
+      }
+    }
   }
   void Leave(const linear::Socket& socket) {
-    lock_guard<linear::mutex> lock(mutex_);
-    std::map<std::string, std::set<linear::Socket> >::iterator pool_it = pool_.begin();
-    while (pool_it != pool_.end()) {
-      std::set<linear::Socket>& sockets = (*pool_it).second;
-      std::set<linear::Socket>::iterator socket_it = sockets.begin();
-      while (socket_it != sockets.end()) {
-        if (socket.GetId() == (*socket_it).GetId()) {
-          LINEAR_LOG(LOG_DEBUG, "leave socket(id = %d) from group_name = \"%s\"",
-                     socket.GetId(), (*pool_it).first.c_str());
-          sockets.erase(*socket_it);
-          break;
-        } else {
-          socket_it++;
-        }
+    Members& members = GetMembers(socket);
+    lock_guard<linear::mutex> members_lock(members.mutex);
+    std::map<int, std::set<std::string> >::iterator it = members.groups.find(socket.GetId());
+    if (it == members.groups.end()) {
+      return;
+    }
+    for (std::set<std::string>::iterator name = it->second.begin(); name != it->second.end(); name++) {
+      if (Remove(*name, socket)) {
+        LINEAR_LOG(LOG_DEBUG, "leave socket(id = %d) from group_name = \"%s\"",
+                   socket.GetId(), name->c_str());
       }
-      pool_it++;
     }
+    members.groups.erase(it);
   }
 
  private:
+  struct Shard {
+    std::map<std::string, Group::Snapshot> groups;
+    linear::mutex mutex;
+  };
+  struct Members {
+    std::map<int, std::set<std::string> > groups;
+    linear::mutex mutex;
+  };
+
   Pool(const Pool& pool);
-  Pool& operator=(const Group& pool);
-  std::map<std::string, std::set<linear::Socket> >pool_;
-  linear::mutex mutex_;
+  Pool& operator=(const Pool& pool);
+
+  // FNV-1a
+  Shard& GetShard(const std::string& name) {
+    uint32_t hash = 2166136261U;
+    for (std::string::const_iterator it = name.begin(); it != name.end(); it++) {
+      hash = (hash ^ static_cast<uint8_t>(*it)) * 16777619U;
+    }
+    return shards_[hash % NUM_OF_SHARDS];
+  }
+  Members& GetMembers(const linear::Socket& socket) {
+    return members_[static_cast<unsigned int>(socket.GetId()) % NUM_OF_SHARDS];
+  }
+  // the first chunk whose last socket is not less than socket, or the last chunk
+  static size_t FindChunk(const Chunks& chunks, const linear::Socket& socket) {
+    size_t low = 0, high = chunks.size();
+    while (low < high) {
+      size_t mid = (low + high) / 2;
+      if (chunks[mid]->back() < socket) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return (low < chunks.size()) ? low : chunks.size() - 1;
+  }
+  // must be called under the shard lock
+  static bool Insert(Group::Snapshot* snapshot, const linear::Socket& socket) {
+    if (snapshot->empty()) {
+      Chunks* chunks = new Chunks();
+      chunks->push_back(linear::shared_ptr<const Chunk>(new Chunk(1, socket)));
+      *snapshot = Group::Snapshot(linear::shared_ptr<const Chunks>(chunks), 1);
+      return true;
+    }
+    const Chunks& olds = *snapshot->GetChunks();
+    size_t index = FindChunk(olds, socket);
+    const Chunk& old = *olds[index];
+    Chunk::const_iterator pos = std::lower_bound(old.begin(), old.end(), socket);
+    if (pos != old.end() && *pos == socket) {
+      return false;
+    }
+    Chunk* chunk = new Chunk();
+    chunk->reserve(old.size() + 1);
+    chunk->insert(chunk->end(), old.begin(), pos);
+    chunk->push_back(socket);
+    chunk->insert(chunk->end(), pos, old.end());
+    Chunks* chunks = new Chunks();
+    chunks->reserve(olds.size() + 1);
+    chunks->insert(chunks->end(), olds.begin(), olds.begin() + index);
+    if (chunk->size() > MAX_CHUNK_SIZE) {
+      // split into halves
+      Chunk::iterator half = chunk->begin() + chunk->size() / 2;
+      chunks->push_back(linear::shared_ptr<const Chunk>(new Chunk(chunk->begin(), half)));
+      chunks->push_back(linear::shared_ptr<const Chunk>(new Chunk(half, chunk->end())));
+      delete chunk;
+    } else {
+      chunks->push_back(linear::shared_ptr<const Chunk>(chunk));
+    }
+    chunks->insert(chunks->end(), olds.begin() + index + 1, olds.end());
+    *snapshot = Group::Snapshot(linear::shared_ptr<const Chunks>(chunks), snapshot->size() + 1);
+    return true;
+  }
+  // must be called under the members lock of socket
+  bool Remove(const std::string& name, const linear::Socket& socket) {
+    Shard& shard = GetShard(name);
+    lock_guard<linear::mutex> lock(shard.mutex);
+    std::map<std::string, Group::Snapshot>::iterator it = shard.groups.find(name);
+    if (it == shard.groups.end() || it->second.empty()) {
+      return false;
+    }
+    Group::Snapshot* snapshot = &it->second;
+    const Chunks& olds = *snapshot->GetChunks();
+    size_t index = FindChunk(olds, socket);
+    const Chunk& old = *olds[index];
+    Chunk::const_iterator pos = std::lower_bound(old.begin(), old.end(), socket);
+    if (pos == old.end() || *pos != socket) {
+      return false;
+    }
+    Chunks* chunks = new Chunks();
+    chunks->reserve(olds.size());
+    chunks->insert(chunks->end(), olds.begin(), olds.begin() + index);
+    if (old.size() > 1) {
+      Chunk* chunk = new Chunk();
+      chunk->reserve(old.size() - 1);
+      chunk->insert(chunk->end(), old.begin(), pos);
+      chunk->insert(chunk->end(), pos + 1, old.end());
+      chunks->push_back(linear::shared_ptr<const Chunk>(chunk));
+    }
+    chunks->insert(chunks->end(), olds.begin() + index + 1, olds.end());
+    *snapshot = Group::Snapshot(linear::shared_ptr<const Chunks>(chunks), snapshot->size() - 1);
+    return true;
+  }
+
+  Shard shards_[NUM_OF_SHARDS];
+  Members members_[NUM_OF_SHARDS];
 };
 
 } // namespace group
@@ -85,6 +215,12 @@ std::vector<std::string> Group::Names() {
 }
 
 std::set<linear::Socket> Group::Get(const std::string& name) {
+  group::Pool& pool = group::Pool::GetInstance();
+  Snapshot snapshot = pool.Get(name);
+  return std::set<linear::Socket>(snapshot.begin(), snapshot.end());
+}
+
+Group::Snapshot Group::GetSnapshot(const std::string& name) {
   group::Pool& pool = group::Pool::GetInstance();
   return pool.Get(name);
 }
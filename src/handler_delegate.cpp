@@ -4,7 +4,9 @@
 
 #include "linear/version.h"
 
+#include "executor_impl.h"
 #include "handler_delegate.h"
+#include "socket_impl.h"
 
 #ifdef WITH_SSL
 # include <openssl/crypto.h>
@@ -60,9 +62,19 @@ void HandlerDelegate::Release(const shared_ptr<SocketImpl>& socket) {
   return pool_.Remove(socket);
 }
 
-void HandlerDelegate::OnConnect(const shared_ptr<SocketImpl>& socket) {
+void HandlerDelegate::SetExecutor(const shared_ptr<ExecutorImpl>& executor) {
+  lock_guard<mutex> lock(executor_mutex_);
+  executor_ = executor;
+}
+
+shared_ptr<ExecutorImpl> HandlerDelegate::GetExecutor() {
+  lock_guard<mutex> lock(executor_mutex_);
+  return executor_;
+}
+
+static void FireOnConnect(const weak_ptr<Handler>& handler_ref, const shared_ptr<SocketImpl>& socket) {
   try {
-    if (shared_ptr<Handler> handler = handler_.lock()) {
+    if (shared_ptr<Handler> handler = handler_ref.lock()) {
       handler->OnConnect(Socket(socket));
     }
   } catch(...) {
@@ -70,9 +82,10 @@ void HandlerDelegate::OnConnect(const shared_ptr<SocketImpl>& socket) {
   }
 }
 
-void HandlerDelegate::OnDisconnect(const shared_ptr<SocketImpl>& socket, const Error& error) {
+static void FireOnDisconnect(const weak_ptr<Handler>& handler_ref, const shared_ptr<SocketImpl>& socket,
+                             const Error& error) {
   try {
-    if (shared_ptr<Handler> handler = handler_.lock()) {
+    if (shared_ptr<Handler> handler = handler_ref.lock()) {
       handler->OnDisconnect(Socket(socket), error);
     }
   } catch(...) {
@@ -80,9 +93,10 @@ void HandlerDelegate::OnDisconnect(const shared_ptr<SocketImpl>& socket, const E
   }
 }
 
-void HandlerDelegate::OnMessage(const shared_ptr<SocketImpl>& socket, const Message& message) {
+static void FireOnMessage(const weak_ptr<Handler>& handler_ref, const shared_ptr<SocketImpl>& socket,
+                          const Message& message) {
   if (message.type == RESPONSE) {
-    Response response = message.as<Response>();
+    const Response& response = message.as<Response>();
     const Request& request = response.request;
     if (request.HasResponseCallback()) {
       try {
@@ -92,7 +106,7 @@ void HandlerDelegate::OnMessage(const shared_ptr<SocketImpl>& socket, const Mess
       }
     } else {
       try {
-        if (shared_ptr<Handler> handler = handler_.lock()) {
+        if (shared_ptr<Handler> handler = handler_ref.lock()) {
           handler->OnMessage(Socket(socket), message);
         }
       } catch(...) {
@@ -101,7 +115,7 @@ void HandlerDelegate::OnMessage(const shared_ptr<SocketImpl>& socket, const Mess
     }
   } else {
     try {
-      if (shared_ptr<Handler> handler = handler_.lock()) {
+      if (shared_ptr<Handler> handler = handler_ref.lock()) {
         handler->OnMessage(Socket(socket), message);
       }
     } catch(...) {
@@ -110,9 +124,10 @@ void HandlerDelegate::OnMessage(const shared_ptr<SocketImpl>& socket, const Mess
   }
 }
 
-void HandlerDelegate::OnError(const shared_ptr<SocketImpl>& socket, const Message& message, const Error& error) {
+static void FireOnError(const weak_ptr<Handler>& handler_ref, const shared_ptr<SocketImpl>& socket,
+                        const Message& message, const Error& error) {
   if (message.type == REQUEST) {
-    Request request = message.as<Request>();
+    const Request& request = message.as<Request>();
     if (request.HasErrorCallback()) {
       try {
         request.FireErrorCallback(Socket(socket), request, error);
@@ -121,7 +136,7 @@ void HandlerDelegate::OnError(const shared_ptr<SocketImpl>& socket, const Messag
       }
     } else {
       try {
-        if (shared_ptr<Handler> handler = handler_.lock()) {
+        if (shared_ptr<Handler> handler = handler_ref.lock()) {
           handler->OnError(Socket(socket), message, error);
         }
       } catch(...) {
@@ -130,7 +145,7 @@ void HandlerDelegate::OnError(const shared_ptr<SocketImpl>& socket, const Messag
     }
   } else {
     try {
-      if (shared_ptr<Handler> handler = handler_.lock()) {
+      if (shared_ptr<Handler> handler = handler_ref.lock()) {
         handler->OnError(Socket(socket), message, error);
       }
     } catch(...) {
@@ -139,4 +154,160 @@ void HandlerDelegate::OnError(const shared_ptr<SocketImpl>& socket, const Messag
   }
 }
 
+// tasks to call handlers on worker threads of executor.
+// messages are copied, and params and results are shared with the originals.
+static Message* CopyMessage(const Message& message) {
+  switch (message.type) {
+  case REQUEST:
+    return new Request(message.as<Request>());
+  case RESPONSE:
+    return new Response(message.as<Response>());
+  case NOTIFY:
+    return new Notify(message.as<Notify>());
+  default:
+    return new Message(message);
+  }
+}
+
+class HandlerTask : public ExecutorImpl::Task {
+ public:
+  HandlerTask(const weak_ptr<Handler>& handler, const shared_ptr<SocketImpl>& socket)
+    : handler_(handler), socket_(socket) {}
+  virtual ~HandlerTask() {}
+
+ protected:
+  weak_ptr<Handler> handler_;
+  shared_ptr<SocketImpl> socket_;
+};
+
+class ConnectTask : public HandlerTask {
+ public:
+  ConnectTask(const weak_ptr<Handler>& handler, const shared_ptr<SocketImpl>& socket)
+    : HandlerTask(handler, socket) {}
+  void Run() {
+    FireOnConnect(handler_, socket_);
+  }
+};
+
+class DisconnectTask : public HandlerTask {
+ public:
+  DisconnectTask(const weak_ptr<Handler>& handler, const shared_ptr<SocketImpl>& socket, const Error& error)
+    : HandlerTask(handler, socket), error_(error) {}
+  void Run() {
+    FireOnDisconnect(handler_, socket_, error_);
+  }
+
+ private:
+  Error error_;
+};
+
+class MessageTask : public HandlerTask {
+ public:
+  MessageTask(const weak_ptr<Handler>& handler, const shared_ptr<SocketImpl>& socket, const Message& message)
+    : HandlerTask(handler, socket), message_(CopyMessage(message)) {}
+  ~MessageTask() {
+    delete message_;
+  }
+  void Run() {
+    FireOnMessage(handler_, socket_, *message_);
+  }
+
+ private:
+  MessageTask(const MessageTask&);
+  MessageTask& operator=(const MessageTask&);
+
+  Message* message_;
+};
+
+class ErrorTask : public HandlerTask {
+ public:
+  ErrorTask(const weak_ptr<Handler>& handler, const shared_ptr<SocketImpl>& socket,
+            const Message& message, const Error& error)
+    : HandlerTask(handler, socket), message_(CopyMessage(message)), error_(error) {}
+  ~ErrorTask() {
+    delete message_;
+  }
+  void Run() {
+    FireOnError(handler_, socket_, *message_, error_);
+  }
+
+ private:
+  ErrorTask(const ErrorTask&);
+  ErrorTask& operator=(const ErrorTask&);
+
+  Message* message_;
+  Error error_;
+};
+
+// all callbacks of a socket go to the same worker, so that they are called in order
+void HandlerDelegate::OnConnect(const shared_ptr<SocketImpl>& socket) {
+  if (shared_ptr<ExecutorImpl> executor = GetExecutor()) {
+    try {
+      executor->Post(socket->GetId(), new ConnectTask(handler_, socket));
+      return;
+    } catch(...) {
+      LINEAR_LOG(LOG_WARN, "fail to post Handler::OnConnect, call it on event loop");
+    }
+  }
+  FireOnConnect(handler_, socket);
+}
+
+void HandlerDelegate::OnDisconnect(const shared_ptr<SocketImpl>& socket, const Error& error) {
+  if (shared_ptr<ExecutorImpl> executor = GetExecutor()) {
+    try {
+      executor->Post(socket->GetId(), new DisconnectTask(handler_, socket, error));
+      return;
+    } catch(...) {
+      LINEAR_LOG(LOG_WARN, "fail to post Handler::OnDisconnect, call it on event loop");
+    }
+  }
+  FireOnDisconnect(handler_, socket, error);
+}
+
+// futures are completed on event loop, so that threads of executor can wait for them
+void HandlerDelegate::OnMessage(const shared_ptr<SocketImpl>& socket, const Message& message) {
+  if (message.type == RESPONSE && message.as<Response>().request.HasFuture()) {
+    const Response& response = message.as<Response>();
+    response.request.CompleteFuture(response);
+    return;
+  }
+  if (shared_ptr<ExecutorImpl> executor = GetExecutor()) {
+    try {
+      // requests and notifies are dropped while the queue is full, not to block event loop.
+      // the peer of a dropped request is answered with an error at once, instead of waiting until timeout
+      bool droppable = (message.type == REQUEST || message.type == NOTIFY);
+      if (!executor->Post(socket->GetId(), new MessageTask(handler_, socket, message), droppable) && droppable) {
+        LINEAR_LOG(LOG_WARN, "drop message(id = %d): fail to post to executor", socket->GetId());
+        if (message.type == REQUEST) {
+          Response busy(message.as<Request>().msgid, type::nil(), std::string("server busy"));
+          Error err = socket->Send(busy, 0);
+          if (err != Error(LNR_OK)) {
+            LINEAR_LOG(LOG_WARN, "fail to send busy response(id = %d): %s", socket->GetId(), err.Message().c_str());
+          }
+        }
+      }
+      return;
+    } catch(...) {
+      LINEAR_LOG(LOG_WARN, "fail to post Handler::OnMessage, call it on event loop");
+    }
+  }
+  FireOnMessage(handler_, socket, message);
+}
+
+void HandlerDelegate::OnError(const shared_ptr<SocketImpl>& socket, const Message& message, const Error& error) {
+  if (message.type == REQUEST && message.as<Request>().HasFuture()) {
+    message.as<Request>().CompleteFuture(error);
+    return;
+  }
+  if (shared_ptr<ExecutorImpl> executor = GetExecutor()) {
+    try {
+      executor->Post(socket->GetId(), new ErrorTask(handler_, socket, message, error));
+      return;
+    } catch(...) {
+      LINEAR_LOG(LOG_WARN, "fail to post Handler::OnError, call it on event loop");
+    }
+  }
+  FireOnError(handler_, socket, message, error);
+}
+
 } // namespace linear
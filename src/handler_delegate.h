@@ -9,6 +9,8 @@
 
 namespace linear {
 
+class ExecutorImpl;
+
 class HandlerDelegate {
  public:
   HandlerDelegate(const linear::weak_ptr<linear::Handler>& handler,
@@ -17,6 +19,8 @@ class HandlerDelegate {
   virtual ~HandlerDelegate();
 
   void SetMaxLimit(size_t max_limit);
+  // handlers are called on worker threads of executor, or on event loop if NULL
+  void SetExecutor(const linear::shared_ptr<linear::ExecutorImpl>& executor);
   virtual linear::Error Retain(const linear::shared_ptr<linear::SocketImpl>& socket);
   virtual void Release(const linear::shared_ptr<linear::SocketImpl>& socket);
 
@@ -33,6 +37,13 @@ class HandlerDelegate {
   linear::shared_ptr<linear::EventLoopImpl> loop_;
   linear::weak_ptr<linear::Handler> handler_;
   linear::SocketPool pool_;
+
+ private:
+  linear::shared_ptr<linear::ExecutorImpl> GetExecutor();
+
+  // set by users while event loops read it
+  linear::shared_ptr<linear::ExecutorImpl> executor_;
+  linear::mutex executor_mutex_;
 };
 
 }  // namespace linear
@@ -0,0 +1,164 @@
+/**
+ * @file id_table.h
+ * Hash table keyed by 32-bit id
+ */
+
+#ifndef LINEAR_ID_TABLE_H_
+#define LINEAR_ID_TABLE_H_
+
+#include <stdint.h>
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace linear {
+
+// IdTable maps a 32-bit id to a pointer in O(1) on average,
+// e.g. msgid to a request waiting for response, or socket id to a socket in a pool.
+// It is an open addressing hash table with linear probing, and removes an entry by
+// shifting following entries backward instead of leaving tombstones, so that lookups
+// stay short even after millions of requests come and go.
+// Values are not owned, and must not be NULL (NULL marks an empty slot).
+// IdTable is not thread safe.
+template <typename T>
+class IdTable {
+ public:
+  static const size_t INITIAL_CAPACITY = 16;
+
+  IdTable() : slots_(INITIAL_CAPACITY), shift_(Shift(INITIAL_CAPACITY)), size_(0) {}
+  ~IdTable() {}
+
+  inline size_t size() const { return size_; }
+  inline size_t capacity() const { return slots_.size(); }
+
+  // throws std::bad_alloc
+  // @return false if id is already used
+  bool Insert(uint32_t id, T* value) {
+    assert(value != NULL);
+    if ((size_ + 1) * 2 > slots_.size()) {
+      Rehash(slots_.size() * 2);
+    }
+    size_t i = Home(id);
+    while (slots_[i].value != NULL) {
+      if (slots_[i].id == id) {
+        return false;
+      }
+      i = Next(i);
+    }
+    slots_[i].id = id;
+    slots_[i].value = value;
+    size_++;
+    return true;
+  }
+  // @return NULL if not found
+  T* Find(uint32_t id) const {
+    size_t i = Lookup(id);
+    return (i == NOT_FOUND) ? NULL : slots_[i].value;
+  }
+  // @return removed value, or NULL if not found
+  T* Remove(uint32_t id) {
+    size_t i = Lookup(id);
+    if (i == NOT_FOUND) {
+      return NULL;
+    }
+    T* value = slots_[i].value;
+    // shift back following entries in the same cluster while they can move toward home
+    size_t j = i;
+    while (true) {
+      j = Next(j);
+      if (slots_[j].value == NULL) {
+        break;
+      }
+      size_t k = Home(slots_[j].id);
+      if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) {
+        continue;
+      }
+      slots_[i] = slots_[j];
+      i = j;
+    }
+    slots_[i].value = NULL;
+    size_--;
+    if (slots_.size() > INITIAL_CAPACITY && size_ * 8 < slots_.size()) {
+      try {
+        Rehash(slots_.size() / 2);
+      } catch(...) {
+        // keep large table
+      }
+    }
+    return value;
+  }
+  // move all values to values, and make the table empty (throws std::bad_alloc)
+  void Release(std::vector<T*>* values) {
+    assert(values != NULL);
+    values->reserve(values->size() + size_);
+    for (typename std::vector<Slot>::iterator it = slots_.begin(); it != slots_.end(); it++) {
+      if (it->value != NULL) {
+        values->push_back(it->value);
+      }
+    }
+    std::vector<Slot>(INITIAL_CAPACITY).swap(slots_);
+    shift_ = Shift(INITIAL_CAPACITY);
+    size_ = 0;
+  }
+
+ private:
+  static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+  struct Slot {
+    Slot() : id(0), value(NULL) {}
+    uint32_t id;
+    T* value;
+  };
+
+  IdTable(const IdTable&);
+  IdTable& operator=(const IdTable&);
+
+  static unsigned int Shift(size_t capacity) {
+    unsigned int shift = 32;
+    while (capacity > 1) {
+      capacity >>= 1;
+      shift--;
+    }
+    return shift;
+  }
+  // fibonacci hashing: ids are sequential per process, and interleaved among sockets
+  inline size_t Home(uint32_t id) const {
+    return static_cast<size_t>(static_cast<uint32_t>(id * 2654435769U) >> shift_);
+  }
+  inline size_t Next(size_t i) const {
+    return (i + 1) & (slots_.size() - 1);
+  }
+  size_t Lookup(uint32_t id) const {
+    size_t i = Home(id);
+    while (slots_[i].value != NULL) {
+      if (slots_[i].id == id) {
+        return i;
+      }
+      i = Next(i);
+    }
+    return NOT_FOUND;
+  }
+  void Rehash(size_t capacity) {
+    std::vector<Slot> slots(capacity);
+    slots.swap(slots_);
+    shift_ = Shift(capacity);
+    for (typename std::vector<Slot>::iterator it = slots.begin(); it != slots.end(); it++) {
+      if (it->value != NULL) {
+        size_t i = Home(it->id);
+        while (slots_[i].value != NULL) {
+          i = Next(i);
+        }
+        slots_[i] = *it;
+      }
+    }
+  }
+
+  std::vector<Slot> slots_;
+  unsigned int shift_;
+  size_t size_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_ID_TABLE_H_
@@ -1,6 +1,7 @@
 #include <stdarg.h>
 #include <time.h>
 
+#include "log_async.h"
 #include "log_stderr.h"
 #include "log_function.h"
 
@@ -20,6 +21,7 @@ static Level g_level = LOG_OFF;
 static bool g_log_stderr = false;
 static bool g_log_file = false;
 static bool g_log_function = false;
+static bool g_log_async = false;
 
 static LogStderr& GetLogStderr() {
   static LogStderr s_stderr;
@@ -33,6 +35,24 @@ static LogFunction& GetLogFunction() {
   static LogFunction s_function;
   return s_function;
 }
+static LogAsync& GetLogAsync() {
+  static LogAsync s_async;
+  return s_async;
+}
+
+// write a record to all enabled sinks, called directly or from the thread of LogAsync
+static void WriteAll(bool debug, Level level, const char* file, int line, const char* func, const char* message,
+                     uint64_t msec) {
+  if (g_log_stderr) {
+    GetLogStderr().Write(debug, level, file, line, func, message, msec);
+  }
+  if (g_log_file) {
+    GetLogFile().Write(debug, level, file, line, func, message, msec);
+  }
+  if (g_log_function) {
+    GetLogFunction().Write(debug, level, file, line, func, message, msec);
+  }
+}
 
 /* functions */
 Level GetLevel() {
@@ -79,6 +99,18 @@ void DisableCallback() {
   }
 }
 
+bool EnableAsync(size_t capacity) {
+  g_log_async = GetLogAsync().Enable(WriteAll, capacity);
+  return g_log_async;
+}
+
+void DisableAsync() {
+  if (g_log_async) {
+    g_log_async = false;
+    GetLogAsync().Disable();
+  }
+}
+
 void Colorize(bool flag) {
   if (g_log_stderr) {
     GetLogStderr().Colorize(flag);
@@ -101,49 +133,69 @@ void Print(bool debug, linear::log::Level level, const char* file, int line, con
 #endif
   va_end(args);
 
-  if (g_log_stderr) {
-    GetLogStderr().Write(debug, level, file, line, func, buffer);
-  }
-  if (g_log_file) {
-    GetLogFile().Write(debug, level, file, line, func, buffer);
-  }
-  if (g_log_function) {
-    GetLogFunction().Write(debug, level, file, line, func, buffer);
+  if (g_log_async) {
+    GetLogAsync().Push(debug, level, file, line, func, buffer, Log::Now());
+    return;
   }
+  WriteAll(debug, level, file, line, func, buffer, Log::Now());
 }
 
 /* Log class methods */
-std::string Log::GetDateTime() {
-  char datetime_str[32];
+uint64_t Log::Now() {
+#ifdef _WIN32
+  FILETIME ft;
+  GetSystemTimeAsFileTime(&ft);
+  ULARGE_INTEGER t;
+  t.LowPart = ft.dwLowDateTime;
+  t.HighPart = ft.dwHighDateTime;
+  return (t.QuadPart - 116444736000000000ULL) / 10000; // 100nsec since 1601 => msec since 1970
+#else
+  struct timeval now;
+  if (gettimeofday(&now, 0) != 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(now.tv_sec) * 1000 + now.tv_usec / 1000;
+#endif
+}
+
+const char* Log::GetDateTime(uint64_t msec) {
+  if (msec == datetime_msec_ && datetime_[0] != '\0') {
+    return datetime_;
+  }
+  datetime_msec_ = msec;
 
 #ifdef _WIN32
+  ULARGE_INTEGER t;
+  t.QuadPart = msec * 10000 + 116444736000000000ULL;
+  FILETIME ft, lft;
+  ft.dwLowDateTime = t.LowPart;
+  ft.dwHighDateTime = t.HighPart;
   SYSTEMTIME st;
-  GetLocalTime(&st);
-  _snprintf_s(datetime_str, sizeof(datetime_str), _TRUNCATE,
-              "%d-%02d-%02d %02d:%02d:%02d.%03d",
-              st.wYear, st.wMonth, st.wDay,
-              st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+  if (!FileTimeToLocalFileTime(&ft, &lft) || !FileTimeToSystemTime(&lft, &st)) {
+    _snprintf_s(datetime_, sizeof(datetime_), _TRUNCATE, "ERR: fail to get date");
+  } else {
+    _snprintf_s(datetime_, sizeof(datetime_), _TRUNCATE,
+                "%d-%02d-%02d %02d:%02d:%02d.%03d",
+                st.wYear, st.wMonth, st.wDay,
+                st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+  }
 #else
   struct tm ts;
-  struct timeval now;
-  struct tm* ret = NULL;
-  if (gettimeofday(&now, 0) == 0) {
-    ret = localtime_r(&now.tv_sec, &ts);
-  }
-  if (ret == NULL) {
-    snprintf(datetime_str, sizeof(datetime_str), "ERR: fail to get date");
+  time_t sec = static_cast<time_t>(msec / 1000);
+  if (msec == 0 || localtime_r(&sec, &ts) == NULL) {
+    snprintf(datetime_, sizeof(datetime_), "ERR: fail to get date");
   } else {
     unsigned int year = ts.tm_year + 1900;
     unsigned int month = ts.tm_mon + 1;
-    snprintf(datetime_str, sizeof(datetime_str),
+    snprintf(datetime_, sizeof(datetime_),
              "%d-%02d-%02d %02d:%02d:%02d.%03d",
              year, month, ts.tm_mday,
              ts.tm_hour, ts.tm_min, ts.tm_sec,
-             static_cast<int>(now.tv_usec / 1000));
+             static_cast<int>(msec % 1000));
   }
 #endif
 
-  return std::string(datetime_str);
+  return datetime_;
 }
 
 }  // namespace log
@@ -1,6 +1,8 @@
 #ifndef	LINEAR_LOG_INTERNAL_H_
 #define	LINEAR_LOG_INTERNAL_H_
 
+#include <stdint.h>
+
 #include "linear/log.h"
 #include "linear/mutex.h"
 
@@ -12,17 +14,30 @@ namespace log {
 
 class Log {
  public:
-  virtual void Write(bool debug, Level level, const char* fname, int line, const char* func, const char* message) = 0;
+  // msec: time of the record in msecs since epoch, that may be earlier than now if written by LogAsync
+  virtual void Write(bool debug, Level level, const char* fname, int line, const char* func, const char* message,
+                     uint64_t msec) = 0;
+  void Write(bool debug, Level level, const char* fname, int line, const char* func, const char* message) {
+    Write(debug, level, fname, line, func, message, Now());
+  }
+  static uint64_t Now();
 
  protected:
-  Log() {}
+  Log() : datetime_msec_(0) {
+    datetime_[0] = '\0';
+  }
   Log(const Log& rhs);
   Log& operator=(const Log& rhs);
   virtual ~Log() {}
   virtual bool Available() = 0;
-  std::string GetDateTime();
+  // formatted only when msec changes, call under mutex_
+  const char* GetDateTime(uint64_t msec);
 
   linear::mutex mutex_;
+
+ private:
+  uint64_t datetime_msec_;
+  char datetime_[32];
 };
 
 }  // namespace log
@@ -0,0 +1,162 @@
+#include <stdio.h>
+
+#include "log.h"
+#include "log_async.h"
+
+namespace linear {
+
+namespace log {
+
+LogAsync::LogAsync()
+  : writer_(NULL), slots_(NULL), capacity_(0), mask_(0), tail_(0), head_(0),
+    dropped_(0), reported_(0), sleeping_(false), stop_(false), running_(false) {
+}
+
+LogAsync::~LogAsync() {
+  Disable();
+  delete[] slots_;
+}
+
+bool LogAsync::Enable(Writer writer, size_t capacity) {
+  if (running_) {
+    return true;
+  }
+  if (writer == NULL) {
+    return false;
+  }
+  size_t size = 2;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  if (slots_ == NULL || size != capacity_) {
+    delete[] slots_;
+    try {
+      slots_ = new Slot[size];
+    } catch(...) {
+      slots_ = NULL;
+      capacity_ = 0;
+      return false;
+    }
+    capacity_ = size;
+    mask_ = static_cast<unsigned long>(size - 1);
+  }
+  for (size_t i = 0; i < capacity_; i++) {
+    slots_[i].sequence.Store(static_cast<unsigned long>(i));
+  }
+  writer_ = writer;
+  tail_.Store(0);
+  head_ = 0;
+  dropped_.Store(0);
+  reported_ = 0;
+  sleeping_.Store(false);
+  stop_.Store(false);
+  if (uv_sem_init(&event_, 0)) {
+    return false;
+  }
+  if (uv_thread_create(&thread_, LogAsync::Run, this)) {
+    uv_sem_destroy(&event_);
+    return false;
+  }
+  running_ = true;
+  return true;
+}
+
+void LogAsync::Disable() {
+  if (!running_) {
+    return;
+  }
+  stop_.Store(true);
+  Wake();
+  uv_thread_join(&thread_);
+  uv_sem_destroy(&event_);
+  running_ = false;
+}
+
+bool LogAsync::Push(bool debug, Level level, const char* file, int line, const char* func, const char* message,
+                    uint64_t msec) {
+  if (!running_) {
+    return false;
+  }
+  unsigned long position = tail_.Load();
+  Slot* slot;
+  while (true) {
+    slot = &slots_[position & mask_];
+    long diff = static_cast<long>(slot->sequence.Load() - position);
+    if (diff == 0) {
+      if (tail_.CompareExchange(position, position + 1)) {
+        break;
+      }
+      position = tail_.Load();
+    } else if (diff < 0) {
+      // the consumer has not popped the record one lap before yet
+      dropped_.Add(1);
+      return false;
+    } else {
+      position = tail_.Load();
+    }
+  }
+  slot->debug = debug;
+  slot->level = level;
+  slot->file = file;
+  slot->line = line;
+  slot->func = func;
+  slot->msec = msec;
+  slot->message.assign(message);
+  slot->sequence.Store(position + 1);
+  Wake();
+  return true;
+}
+
+bool LogAsync::Pop() {
+  Slot& slot = slots_[head_ & mask_];
+  if (slot.sequence.Load() != head_ + 1) {
+    return false;
+  }
+  writer_(slot.debug, slot.level, slot.file, slot.line, slot.func, slot.message.c_str(), slot.msec);
+  slot.sequence.Store(head_ + static_cast<unsigned long>(capacity_));
+  head_++;
+  return true;
+}
+
+// wake the background thread only if it is going to sleep, so producers do not touch the semaphore usually
+void LogAsync::Wake() {
+  if (sleeping_.Load() && sleeping_.CompareExchange(true, false)) {
+    uv_sem_post(&event_);
+  }
+}
+
+void LogAsync::Run(void* arg) {
+  LogAsync* self = static_cast<LogAsync*>(arg);
+  while (true) {
+    while (self->Pop()) {
+    }
+    unsigned long dropped = self->dropped_.Load();
+    if (dropped != self->reported_) {
+      char message[64];
+#ifdef _WIN32
+      _snprintf_s(message, sizeof(message), _TRUNCATE, "%lu log records are dropped", dropped - self->reported_);
+#else
+      snprintf(message, sizeof(message), "%lu log records are dropped", dropped - self->reported_);
+#endif
+      self->writer_(false, LOG_WARN, __FILE__, __LINE__, __LINEAR_PRETTY_FUNCTION__, message, Log::Now());
+      self->reported_ = dropped;
+    }
+    if (self->stop_.Load()) {
+      break;
+    }
+    // check again after announcing to sleep, not to miss a record pushed meanwhile
+    self->sleeping_.Store(true);
+    Slot& next = self->slots_[self->head_ & self->mask_];
+    if (self->stop_.Load() || next.sequence.Load() == self->head_ + 1) {
+      if (self->sleeping_.CompareExchange(true, false)) {
+        continue;
+      }
+      // a producer has already taken the flag, and posts
+    }
+    uv_sem_wait(&self->event_);
+  }
+}
+
+}  // namespace log
+
+}  // namespace linear
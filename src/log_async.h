@@ -0,0 +1,85 @@
+#ifndef	LINEAR_LOG_ASYNC_H_
+#define	LINEAR_LOG_ASYNC_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "tv.h"
+#include "linear/log.h"
+
+#include "atomic.h"
+
+namespace linear {
+
+namespace log {
+
+// LogAsync passes log records from any threads to a background thread that writes them to sinks.
+// - records are queued into a bounded lock-free ring (multi producer, single consumer),
+//   and the caller returns without waiting for the date formatting and the I/O of sinks
+// - when the ring is full, the new record is dropped and counted,
+//   and the number of dropped records is written as a warning by the background thread
+// - file and func must be string literals (__FILE__, __PRETTY_FUNCTION__), only their pointers are queued
+// - message buffers are kept in the ring and reused, so no allocation happens once they grow enough
+class LogAsync {
+ public:
+  typedef void (*Writer)(bool debug, Level level, const char* file, int line, const char* func,
+                         const char* message, uint64_t msec);
+
+  static const size_t DEFAULT_CAPACITY = 4096;
+
+  LogAsync();
+  ~LogAsync();
+  // capacity is rounded up to a power of 2
+  bool Enable(Writer writer, size_t capacity = DEFAULT_CAPACITY);
+  // write all queued records and stop the background thread
+  void Disable();
+  // return false if the record is dropped
+  bool Push(bool debug, Level level, const char* file, int line, const char* func, const char* message,
+            uint64_t msec);
+  unsigned long GetDropped() const {
+    return dropped_.Load();
+  }
+
+ private:
+  LogAsync(const LogAsync& rhs);
+  LogAsync& operator=(const LogAsync& rhs);
+
+  // sequence == position: free for the producer at position
+  // sequence == position + 1: filled for the consumer at position
+  struct Slot {
+    Slot() : sequence(0), debug(false), level(LOG_OFF), file(NULL), line(0), func(NULL), msec(0) {}
+    linear::Atomic<unsigned long> sequence;
+    bool debug;
+    Level level;
+    const char* file;
+    int line;
+    const char* func;
+    uint64_t msec;
+    std::string message;
+  };
+
+  static void Run(void* arg);
+  bool Pop();
+  void Wake();
+
+  Writer writer_;
+  Slot* slots_;
+  size_t capacity_;
+  unsigned long mask_;
+  linear::Atomic<unsigned long> tail_; // next position to push
+  unsigned long head_;                 // next position to pop, touched only by the background thread
+  linear::Atomic<unsigned long> dropped_;
+  unsigned long reported_;
+  linear::Atomic<bool> sleeping_;
+  linear::Atomic<bool> stop_;
+  bool running_;
+  uv_sem_t event_;
+  uv_thread_t thread_;
+};
+
+}  // namespace log
+
+}  // namespace linear
+
+#endif	// LINEAR_LOG_ASYNC_H_
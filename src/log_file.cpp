@@ -40,7 +40,8 @@ void LogFile::Colorize(bool flag) {
   color_ = flag;
 }
 
-void LogFile::Write(bool debug, Level level, const char* file, int line, const char* func, const char* message) {
+void LogFile::Write(bool debug, Level level, const char* file, int line, const char* func, const char* message,
+                    uint64_t msec) {
   linear::lock_guard<linear::mutex> lock(mutex_);
 
   if (fp_ == NULL) {
@@ -83,7 +84,7 @@ void LogFile::Write(bool debug, Level level, const char* file, int line, const c
 
   (void)(func);
   fprintf(fp_, "%s: [%s] (%s:%d) %s\n",
-          GetDateTime().c_str(),
+          GetDateTime(msec),
           strptr,
           (n == std::string::npos) ? fname.c_str() : fname.substr(n + 1).c_str(), line,
           message);
@@ -91,7 +92,7 @@ void LogFile::Write(bool debug, Level level, const char* file, int line, const c
   (void)(file);
   (void)(line);
   (void)(func);
-  fprintf(fp_, "%s: [%s] %s\n", GetDateTime().c_str(), strptr, message);
+  fprintf(fp_, "%s: [%s] %s\n", GetDateTime(msec), strptr, message);
 #endif
 
   if (color_) {
@@ -17,7 +17,9 @@ class LogFile : public Log {
   virtual bool Enable(const std::string& filename);
   virtual void Disable();
   void Colorize(bool flag);
-  void Write(bool debug, linear::log::Level level, const char* file, int line, const char* func, const char* message);
+  using Log::Write;
+  void Write(bool debug, linear::log::Level level, const char* file, int line, const char* func, const char* message,
+             uint64_t msec);
 
  protected:
   FILE* fp_;
@@ -24,8 +24,10 @@ void LogFunction::Disable() {
   callback_ = NULL;
 }
 
-void LogFunction::Write(bool debug, Level level, const char* file, int line, const char* func, const char* message) {
+void LogFunction::Write(bool debug, Level level, const char* file, int line, const char* func, const char* message,
+                        uint64_t msec) {
   (void) debug; // not used debug flag here now
+  (void) msec;
   linear::lock_guard<linear::mutex> lock(mutex_);
   if (callback_ == NULL) {
     return;
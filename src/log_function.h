@@ -14,7 +14,9 @@ class LogFunction : public Log {
   bool Available();
   bool Enable(LogCallback callback);
   void Disable();
-  void Write(bool debug, linear::log::Level level, const char* file, int line, const char* func, const char* message);
+  using Log::Write;
+  void Write(bool debug, linear::log::Level level, const char* file, int line, const char* func, const char* message,
+             uint64_t msec);
 
  private:
   LogFunction(const LogFunction& rhs);
@@ -2,6 +2,10 @@
 #include "linear/mutex.h"
 #include "linear/message.h"
 #include "linear/group.h"
+#include "linear/packed_message.h"
+
+#include "future_impl.h"
+#include "packed_message_impl.h"
 
 using namespace linear::log;
 
@@ -15,6 +19,10 @@ static uint32_t GetId() {
   return ++id;
 }
 
+uint32_t GenerateMsgid() {
+  return GetId();
+}
+
 Request::Request() : Message(linear::REQUEST), msgid(GetId()), timeout_(30000) {
 }
 
@@ -32,6 +40,36 @@ Error Request::Send(const Socket& socket, int timeout) const {
   return Send(socket);
 }
 
+Future Request::SendAsync(const Socket& socket, int timeout) const {
+  // the completion state outlives the pending-request slot (that is deleted when answered),
+  // so it is allocated here and shared by the future and the copy of this request in the slot
+  shared_ptr<FutureImpl> impl(new FutureImpl());
+  Request request(*this);
+  request.timeout_ = timeout;
+  request.future_ = impl;
+  Error err = socket.Send(request, timeout);
+  if (err != Error(LNR_OK)) {
+    impl->Complete(Response(), err);
+  }
+  return Future(impl);
+}
+
+bool Request::HasFuture() const {
+  return (bool) future_;
+}
+
+void Request::CompleteFuture(const Response& response) const {
+  shared_ptr<FutureImpl> future = future_;
+  // response.request refers to the future, so drop it to avoid circular reference
+  Response completed(response);
+  completed.request.future_.reset();
+  future->Complete(completed, Error(LNR_OK));
+}
+
+void Request::CompleteFuture(const Error& error) const {
+  future_->Complete(Response(), error);
+}
+
 bool Request::HasResponseCallback() const {
   return (bool) on_response_holder_;
 }
@@ -46,6 +84,17 @@ void Request::FireErrorCallback(const Socket& socket, const Request& request, co
   on_error_holder_->Fire(socket, request, error);
 }
 
+void Request::swap(Request& request) {
+  std::swap(type, request.type);
+  std::swap(msgid, request.msgid);
+  method.swap(request.method);
+  params.swap(request.params);
+  std::swap(timeout_, request.timeout_);
+  on_response_holder_.swap(request.on_response_holder_);
+  on_error_holder_.swap(request.on_error_holder_);
+  future_.swap(request.future_);
+}
+
 Error Response::Send(const Socket& socket) const {
   return socket.Send(*this, 0);
 }
@@ -55,41 +104,12 @@ Error Notify::Send(const Socket& socket) const {
 }
 
 void Notify::Send(const std::string& group_name) const {
-  std::set<linear::Socket> sockets = Group::Get(group_name);
-  if (sockets.empty()) {
-    return;
-  }
-  if (group_name == std::string(LINEAR_BROADCAST_GROUP)) {
-    LINEAR_LOG(LOG_DEBUG, "Send to broadcast group");
-  } else {
-    LINEAR_LOG(LOG_DEBUG, "Send to group: \"%s\"", group_name.c_str());
-  }
-  std::set<linear::Socket>::iterator it = sockets.begin();
-  while (it != sockets.end()) {
-    (*it).Send(*this, 0);
-    it++;
-  }
+  // pack once, and share the packed data among all sockets
+  linear::PackedMessage(*this).Send(group_name);
 }
 
 void Notify::Send(const std::string& group_name, const Socket& except_socket) const {
-  std::set<linear::Socket> sockets = Group::Get(group_name);
-  if (sockets.empty()) {
-    return;
-  }
-  if (group_name == std::string(LINEAR_BROADCAST_GROUP)) {
-    LINEAR_LOG(LOG_DEBUG, "Send to broadcast group except for socket(id = %d)",
-               except_socket.GetId());
-  } else {
-    LINEAR_LOG(LOG_DEBUG, "Send to group: \"%s\" except for socket(id = %d)",
-               group_name.c_str(), except_socket.GetId());
-  }
-  std::set<linear::Socket>::iterator it = sockets.begin();
-  while (it != sockets.end()) {
-    if ((*it) != except_socket) {
-      (*it).Send(*this, 0);
-    }
-    it++;
-  }
+  linear::PackedMessage(*this).Send(group_name, except_socket);
 }
 
 }  // namespace linear
@@ -0,0 +1,69 @@
+/**
+ * @file message_decoder.h
+ * Message decoder class definition
+ */
+
+#ifndef LINEAR_MESSAGE_DECODER_H_
+#define LINEAR_MESSAGE_DECODER_H_
+
+#include <typeinfo>
+
+#include "linear/message.h"
+
+namespace linear {
+
+// MessageDecoder converts an unpacked message into Request, Response or Notify in one pass.
+// The array header and the type tag are checked only once by GetType, and Decode fills
+// the final object directly from the elements.
+// params (or result / error) take over the zone of object_handle instead of being copied,
+// and share it with their copies, so Decode must be called at most once for each object_handle.
+// Invalid messages throw std::bad_cast (msgpack::type_error is derived from it).
+class MessageDecoder {
+ public:
+  static linear::message_type_t GetType(const msgpack::object& obj) {
+    if (obj.type != msgpack::type::ARRAY || obj.via.array.size == 0 ||
+        obj.via.array.ptr[0].type != msgpack::type::POSITIVE_INTEGER ||
+        obj.via.array.ptr[0].via.u64 >= linear::UNDEFINED) {
+      return linear::UNDEFINED;
+    }
+    return static_cast<linear::message_type_t>(obj.via.array.ptr[0].via.u64);
+  }
+  // [type, msgid, method, params]
+  static void Decode(msgpack::object_handle& handle, linear::Request* request) {
+    const msgpack::object* elements = Elements(handle.get(), linear::REQUEST, 4);
+    request->msgid = elements[1].as<uint32_t>();
+    elements[2].convert(request->method);
+    request->params.adopt(elements[3], handle.zone().release());
+  }
+  // [type, msgid, error, result]
+  static void Decode(msgpack::object_handle& handle, linear::Response* response) {
+    const msgpack::object* elements = Elements(handle.get(), linear::RESPONSE, 4);
+    response->msgid = elements[1].as<uint32_t>();
+    // one of them is nil in most cases, and the other takes over the zone
+    if (elements[3].is_nil() && !elements[2].is_nil()) {
+      response->result = elements[3];
+      response->error.adopt(elements[2], handle.zone().release());
+    } else {
+      response->error = elements[2];
+      response->result.adopt(elements[3], handle.zone().release());
+    }
+  }
+  // [type, method, params]
+  static void Decode(msgpack::object_handle& handle, linear::Notify* notify) {
+    const msgpack::object* elements = Elements(handle.get(), linear::NOTIFY, 3);
+    elements[1].convert(notify->method);
+    notify->params.adopt(elements[2], handle.zone().release());
+  }
+
+ private:
+  static const msgpack::object* Elements(const msgpack::object& obj, linear::message_type_t type, uint32_t size) {
+    if (GetType(obj) != type || obj.via.array.size < size) {
+      throw std::bad_cast();
+    }
+    return obj.via.array.ptr;
+  }
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_MESSAGE_DECODER_H_
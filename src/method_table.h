@@ -0,0 +1,208 @@
+/**
+ * @file method_table.h
+ * Hash table keyed by method name
+ */
+
+#ifndef LINEAR_METHOD_TABLE_H_
+#define LINEAR_METHOD_TABLE_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace linear {
+
+// MethodTable maps a method name to a value in O(1).
+// It is an open addressing hash table with linear probing while methods are registered.
+// Seal rebuilds it as a perfect hash by hash and displace:
+// methods are split into buckets by the first hash, and each bucket has a seed (displacement)
+// of the second hash that places all methods of the bucket in free slots,
+// so that a lookup is two hashes and at most one string compare, with less than 2 slots per method.
+// Methods cannot be added after Seal.
+// MethodTable is not thread safe, but lookups are safe if nothing is added any more.
+template <typename T>
+class MethodTable {
+ public:
+  static const size_t INITIAL_CAPACITY = 16;
+  static const size_t BUCKET_SIZE = 2; // average number of methods per bucket
+
+  MethodTable() : slots_(INITIAL_CAPACITY), size_(0), sealed_(false) {}
+  ~MethodTable() {}
+
+  inline size_t size() const { return size_; }
+  inline size_t capacity() const { return slots_.size(); }
+  inline bool sealed() const { return sealed_; }
+
+  // throws std::bad_alloc
+  // @return false if method is already used, or sealed
+  bool Insert(const std::string& method, const T& value) {
+    if (sealed_ || Find(method) != NULL) {
+      return false;
+    }
+    if ((size_ + 1) * 2 > slots_.size()) {
+      Rebuild(slots_.size() * 2);
+    }
+    Place(&slots_, method, value);
+    size_++;
+    return true;
+  }
+  // @return NULL if not found
+  const T* Find(const std::string& method) const {
+    size_t mask = slots_.size() - 1;
+    if (sealed_) {
+      uint32_t displacement = displacements_[Hash(method, 0) & (displacements_.size() - 1)];
+      size_t i = Hash(method, displacement) & mask;
+      return (slots_[i].used && slots_[i].method == method) ? &slots_[i].value : NULL;
+    }
+    size_t i = Hash(method, 0) & mask;
+    while (slots_[i].used) {
+      if (slots_[i].method == method) {
+        return &slots_[i].value;
+      }
+      i = (i + 1) & mask;
+    }
+    return NULL;
+  }
+  // build a perfect hash in the smallest power of 2 slots not less than size,
+  // and double slots only if some bucket cannot be placed (throws std::bad_alloc)
+  void Seal() {
+    if (sealed_) {
+      return;
+    }
+    size_t capacity = 1;
+    while (capacity < size_) {
+      capacity <<= 1;
+    }
+    while (!Displace(capacity)) {
+      capacity <<= 1;
+    }
+    sealed_ = true;
+  }
+
+  // FNV-1a
+  static uint32_t Hash(const std::string& method, uint32_t seed) {
+    uint32_t hash = 2166136261U ^ (seed * 2654435769U);
+    for (std::string::const_iterator it = method.begin(); it != method.end(); it++) {
+      hash ^= static_cast<uint8_t>(*it);
+      hash *= 16777619U;
+    }
+    // low bits of FNV-1a depend only on low bits of characters, so mix high bits into them
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35U;
+    hash ^= hash >> 16;
+    return hash;
+  }
+
+ private:
+  struct Slot {
+    Slot() : used(false) {}
+    std::string method;
+    T value;
+    bool used;
+  };
+
+  MethodTable(const MethodTable&);
+  MethodTable& operator=(const MethodTable&);
+
+  static void Place(std::vector<Slot>* slots, const std::string& method, const T& value) {
+    size_t mask = slots->size() - 1;
+    size_t i = Hash(method, 0) & mask;
+    while ((*slots)[i].used) {
+      i = (i + 1) & mask;
+    }
+    (*slots)[i].method = method;
+    (*slots)[i].value = value;
+    (*slots)[i].used = true;
+  }
+  struct LargerBucket {
+    explicit LargerBucket(const std::vector<std::vector<const Slot*> >& b) : buckets(b) {}
+    bool operator()(size_t lhs, size_t rhs) const {
+      return buckets[lhs].size() > buckets[rhs].size();
+    }
+    const std::vector<std::vector<const Slot*> >& buckets;
+  };
+  // place larger buckets first while many slots are free,
+  // then a bucket of one method needs capacity / (free slots) trials on average
+  bool Displace(size_t capacity) {
+    size_t num_of_buckets = 1;
+    while (num_of_buckets * BUCKET_SIZE < size_) {
+      num_of_buckets <<= 1;
+    }
+    std::vector<std::vector<const Slot*> > buckets(num_of_buckets);
+    for (typename std::vector<Slot>::const_iterator it = slots_.begin(); it != slots_.end(); it++) {
+      if (it->used) {
+        buckets[Hash(it->method, 0) & (num_of_buckets - 1)].push_back(&(*it));
+      }
+    }
+    std::vector<size_t> order(num_of_buckets);
+    for (size_t i = 0; i < num_of_buckets; i++) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), LargerBucket(buckets));
+
+    const uint32_t max_trials = static_cast<uint32_t>(capacity * 4 + 64);
+    std::vector<bool> taken(capacity, false);
+    std::vector<uint32_t> displacements(num_of_buckets, 0);
+    std::vector<size_t> positions;
+    for (std::vector<size_t>::const_iterator b = order.begin(); b != order.end() && !buckets[*b].empty(); b++) {
+      const std::vector<const Slot*>& bucket = buckets[*b];
+      uint32_t displacement = 1;
+      for (; displacement <= max_trials; displacement++) {
+        positions.clear();
+        for (size_t k = 0; k < bucket.size(); k++) {
+          size_t i = Hash(bucket[k]->method, displacement) & (capacity - 1);
+          if (taken[i] || std::find(positions.begin(), positions.end(), i) != positions.end()) {
+            break;
+          }
+          positions.push_back(i);
+        }
+        if (positions.size() == bucket.size()) {
+          break;
+        }
+      }
+      if (displacement > max_trials) {
+        return false;
+      }
+      for (size_t k = 0; k < positions.size(); k++) {
+        taken[positions[k]] = true;
+      }
+      displacements[*b] = displacement;
+    }
+
+    std::vector<Slot> slots(capacity);
+    for (size_t b = 0; b < num_of_buckets; b++) {
+      for (size_t k = 0; k < buckets[b].size(); k++) {
+        Slot& slot = slots[Hash(buckets[b][k]->method, displacements[b]) & (capacity - 1)];
+        slot.method = buckets[b][k]->method;
+        slot.value = buckets[b][k]->value;
+        slot.used = true;
+      }
+    }
+    slots_.swap(slots);
+    displacements_.swap(displacements);
+    return true;
+  }
+  void Rebuild(size_t capacity) {
+    std::vector<Slot> slots(capacity);
+    for (typename std::vector<Slot>::const_iterator it = slots_.begin(); it != slots_.end(); it++) {
+      if (it->used) {
+        Place(&slots, it->method, it->value);
+      }
+    }
+    slots_.swap(slots);
+  }
+
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> displacements_; // by bucket, used after Seal
+  size_t size_;
+  bool sealed_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_METHOD_TABLE_H_
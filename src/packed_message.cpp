@@ -0,0 +1,127 @@
+#include "linear/group.h"
+#include "linear/log.h"
+#include "linear/packed_message.h"
+
+#include "packed_message_impl.h"
+
+using namespace linear::log;
+
+namespace linear {
+
+PackedMessage::PackedMessage() {
+}
+
+PackedMessage::PackedMessage(const Message& message) {
+  try {
+    message_ = shared_ptr<PackedMessageImpl>(new PackedMessageImpl(message));
+  } catch(const std::bad_typeid&) {
+    LINEAR_LOG(LOG_ERR, "fail to pack message: invalid type of message");
+  } catch(...) {
+    LINEAR_LOG(LOG_ERR, "no memory");
+  }
+}
+
+PackedMessage::PackedMessage(const char* data, size_t size) {
+  if (data == NULL || size == 0) {
+    return;
+  }
+  try {
+    message_ = shared_ptr<PackedMessageImpl>(new PackedMessageImpl(data, size));
+  } catch(const std::bad_alloc&) {
+    LINEAR_LOG(LOG_ERR, "no memory");
+  } catch(...) {
+    LINEAR_LOG(LOG_WARN, "fail to unpack message: invalid or malformed data");
+  }
+}
+
+PackedMessage::PackedMessage(const PackedMessage& message) : message_(message.message_) {
+}
+
+PackedMessage& PackedMessage::operator=(const PackedMessage& message) {
+  message_ = message.message_;
+  return *this;
+}
+
+PackedMessage::~PackedMessage() {
+}
+
+message_type_t PackedMessage::GetType() const {
+  if (!message_) {
+    return linear::UNDEFINED;
+  }
+  return message_->GetMessage().type;
+}
+
+const char* PackedMessage::GetData() const {
+  if (!message_) {
+    return NULL;
+  }
+  return message_->data();
+}
+
+size_t PackedMessage::GetSize() const {
+  if (!message_) {
+    return 0;
+  }
+  return message_->size();
+}
+
+Error PackedMessage::Send(const Socket& socket) const {
+  return socket.Send(*this);
+}
+
+Error PackedMessage::Send(const Socket& socket, int timeout) const {
+  return socket.Send(*this, timeout);
+}
+
+void PackedMessage::Send(const std::string& group_name) const {
+  if (GetType() != linear::NOTIFY) {
+    LINEAR_LOG(LOG_WARN, "only notify can be sent to group");
+    return;
+  }
+  Group::Snapshot sockets = Group::GetSnapshot(group_name);
+  if (sockets.empty()) {
+    return;
+  }
+  if (group_name == std::string(LINEAR_BROADCAST_GROUP)) {
+    LINEAR_LOG(LOG_DEBUG, "Send to broadcast group");
+  } else {
+    LINEAR_LOG(LOG_DEBUG, "Send to group: \"%s\"", group_name.c_str());
+  }
+  Group::Snapshot::const_iterator it = sockets.begin();
+  while (it != sockets.end()) {
+    (*it).Send(*this);
+    it++;
+  }
+}
+
+void PackedMessage::Send(const std::string& group_name, const Socket& except_socket) const {
+  if (GetType() != linear::NOTIFY) {
+    LINEAR_LOG(LOG_WARN, "only notify can be sent to group");
+    return;
+  }
+  Group::Snapshot sockets = Group::GetSnapshot(group_name);
+  if (sockets.empty()) {
+    return;
+  }
+  if (group_name == std::string(LINEAR_BROADCAST_GROUP)) {
+    LINEAR_LOG(LOG_DEBUG, "Send to broadcast group except for socket(id = %d)",
+               except_socket.GetId());
+  } else {
+    LINEAR_LOG(LOG_DEBUG, "Send to group: \"%s\" except for socket(id = %d)",
+               group_name.c_str(), except_socket.GetId());
+  }
+  Group::Snapshot::const_iterator it = sockets.begin();
+  while (it != sockets.end()) {
+    if ((*it) != except_socket) {
+      (*it).Send(*this);
+    }
+    it++;
+  }
+}
+
+const shared_ptr<PackedMessageImpl>& PackedMessage::GetImpl() const {
+  return message_;
+}
+
+}  // namespace linear
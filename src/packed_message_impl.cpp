@@ -0,0 +1,100 @@
+#include <stdexcept>
+#include <typeinfo>
+
+#include "linear/log.h"
+
+#include "packed_message_impl.h"
+
+using namespace linear::log;
+
+namespace linear {
+
+PackedMessageImpl::PackedMessageImpl(const Message& message) : message_(NULL) {
+  Pack(message);
+}
+
+PackedMessageImpl::PackedMessageImpl(const char* data, size_t size) : message_(NULL) {
+  size_t offset = 0;
+  msgpack::object_handle handle;
+  msgpack::unpack(handle, data, size, offset);
+  if (offset != size) {
+    throw std::runtime_error("extra bytes");
+  }
+  msgpack::object obj = handle.get();
+  Message message = obj.as<Message>();
+  switch(message.type) {
+  case REQUEST:
+    // pack again to put msgid as uint32
+    Pack(obj.as<Request>());
+    return;
+  case RESPONSE:
+    message_ = new Response(obj.as<Response>());
+    break;
+  case NOTIFY:
+    message_ = new Notify(obj.as<Notify>());
+    break;
+  default:
+    throw std::bad_cast();
+  }
+  try {
+    buffer_.write(data, size);
+  } catch(...) {
+    delete message_;
+    throw;
+  }
+}
+
+PackedMessageImpl::~PackedMessageImpl() {
+  delete message_;
+}
+
+void PackedMessageImpl::Pack(const Message& message) {
+  switch(message.type) {
+  case REQUEST:
+    {
+      Request* request = new Request(static_cast<const Request&>(message));
+      message_ = request;
+      try {
+        msgpack::packer<msgpack::sbuffer> packer(buffer_);
+        packer.pack_array(4);
+        packer.pack(request->type);
+        packer.pack_fix_uint32(request->msgid);
+        packer.pack(request->method);
+        packer.pack(request->params);
+      } catch(...) {
+        delete message_;
+        throw;
+      }
+    }
+    break;
+  case RESPONSE:
+    {
+      Response* response = new Response(static_cast<const Response&>(message));
+      message_ = response;
+      try {
+        msgpack::pack(buffer_, *response);
+      } catch(...) {
+        delete message_;
+        throw;
+      }
+    }
+    break;
+  case NOTIFY:
+    {
+      Notify* notify = new Notify(static_cast<const Notify&>(message));
+      message_ = notify;
+      try {
+        msgpack::pack(buffer_, *notify);
+      } catch(...) {
+        delete message_;
+        throw;
+      }
+    }
+    break;
+  default:
+    LINEAR_LOG(LOG_ERR, "invalid type of message: %d", message.type);
+    throw std::bad_typeid();
+  }
+}
+
+}  // namespace linear
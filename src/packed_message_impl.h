@@ -0,0 +1,47 @@
+#ifndef LINEAR_PACKED_MESSAGE_IMPL_H_
+#define LINEAR_PACKED_MESSAGE_IMPL_H_
+
+#include "linear/message.h"
+
+namespace linear {
+
+// new msgid for Request (defined in message.cpp)
+uint32_t GenerateMsgid();
+
+// PackedMessageImpl holds a message packed once, that is immutable and shared by several sends.
+// A copy of the message is kept to report errors through Handler::OnError.
+// msgid of Request is always packed as uint32, so that it can be patched in a copy of data.
+class PackedMessageImpl {
+ public:
+  // offset of msgid in packed Request: fixarray(1byte) + type(1byte) + uint32 prefix(1byte)
+  static const size_t MSGID_OFFSET = 3;
+
+  // throws std::bad_alloc, std::bad_typeid
+  explicit PackedMessageImpl(const linear::Message& message);
+  // throws std::bad_alloc, std::bad_cast (msgpack::type_error), std::runtime_error (malformed data)
+  PackedMessageImpl(const char* data, size_t size);
+  ~PackedMessageImpl();
+
+  inline const char* data() const { return buffer_.data(); }
+  inline size_t size() const { return buffer_.size(); }
+  inline const linear::Message& GetMessage() const { return *message_; }
+
+  static inline void PatchMsgid(char* data, uint32_t msgid) {
+    data[MSGID_OFFSET]     = static_cast<char>((msgid >> 24) & 0xff);
+    data[MSGID_OFFSET + 1] = static_cast<char>((msgid >> 16) & 0xff);
+    data[MSGID_OFFSET + 2] = static_cast<char>((msgid >> 8) & 0xff);
+    data[MSGID_OFFSET + 3] = static_cast<char>(msgid & 0xff);
+  }
+
+ private:
+  PackedMessageImpl(const PackedMessageImpl&);
+  PackedMessageImpl& operator=(const PackedMessageImpl&);
+  void Pack(const linear::Message& message);
+
+  msgpack::sbuffer buffer_;
+  linear::Message* message_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_PACKED_MESSAGE_IMPL_H_
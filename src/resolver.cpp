@@ -0,0 +1,118 @@
+#include <map>
+
+#include "tv.h"
+#include "linear/log.h"
+#include "linear/mutex.h"
+
+#include "resolver.h"
+
+using namespace linear::log;
+
+namespace linear {
+
+namespace resolver {
+
+static uint64_t Now() {
+  return uv_hrtime() / 1000000;
+}
+
+// Cache maps host names to the addresses that sockets connected to.
+// a client process connects to a few hosts, so a map under one lock is enough.
+class Cache {
+ public:
+  static Cache& GetInstance() {
+    static Cache cache;
+    return cache;
+  }
+  Cache() {}
+  ~Cache() {}
+  bool Get(const std::string& host, Addrinfo* info) {
+    lock_guard<mutex> lock(mutex_);
+    std::map<std::string, Entry>::iterator it = entries_.find(host);
+    if (it == entries_.end()) {
+      return false;
+    }
+    if (it->second.expire <= Now()) {
+      LINEAR_DEBUG(LOG_DEBUG, "cached address of %s is expired", host.c_str());
+      entries_.erase(it);
+      return false;
+    }
+    info->addr = it->second.addr;
+    info->proto = it->second.proto;
+    return true;
+  }
+  void Set(const std::string& host, const Addrinfo& info, unsigned int ttl) {
+    lock_guard<mutex> lock(mutex_);
+    entries_[host] = Entry(info.addr, info.proto, Now() + ttl);
+  }
+  void Remove(const std::string& host) {
+    lock_guard<mutex> lock(mutex_);
+    entries_.erase(host);
+  }
+  void Clear() {
+    lock_guard<mutex> lock(mutex_);
+    entries_.clear();
+  }
+
+ private:
+  struct Entry {
+    Entry() : proto(Addrinfo::UNKNOWN), expire(0) {}
+    Entry(const std::string& a, Addrinfo::Protocol p, uint64_t e) : addr(a), proto(p), expire(e) {}
+    ~Entry() {}
+    std::string addr;
+    Addrinfo::Protocol proto;
+    uint64_t expire; // msec
+  };
+
+  Cache(const Cache& cache);
+  Cache& operator=(const Cache& cache);
+
+  std::map<std::string, Entry> entries_;
+  linear::mutex mutex_;
+};
+
+}  // namespace resolver
+
+bool Resolver::IsNumeric(const std::string& host, Addrinfo::Protocol* proto) {
+  unsigned char addr[sizeof(struct in6_addr)];
+  if (uv_inet_pton(AF_INET, host.c_str(), addr) == 0) {
+    if (proto != NULL) {
+      *proto = Addrinfo::IPv4;
+    }
+    return true;
+  }
+  if (uv_inet_pton(AF_INET6, host.c_str(), addr) == 0) {
+    if (proto != NULL) {
+      *proto = Addrinfo::IPv6;
+    }
+    return true;
+  }
+  return false;
+}
+
+Addrinfo Resolver::Lookup(const std::string& host, int port) {
+  Addrinfo info;
+  info.addr = host;
+  info.port = port;
+  if (!IsNumeric(host, &info.proto)) {
+    resolver::Cache::GetInstance().Get(host, &info);
+  }
+  return info;
+}
+
+void Resolver::Store(const std::string& host, const Addrinfo& resolved, unsigned int ttl) {
+  if (resolved.proto == Addrinfo::UNKNOWN || IsNumeric(host)) {
+    return;
+  }
+  resolver::Cache::GetInstance().Set(host, resolved, ttl);
+}
+
+void Resolver::Remove(const std::string& host) {
+  resolver::Cache::GetInstance().Remove(host);
+}
+
+void Resolver::Clear() {
+  resolver::Cache::GetInstance().Clear();
+}
+
+}  // namespace linear
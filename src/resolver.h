@@ -0,0 +1,37 @@
+/**
+ * @file resolver.h
+ * Resolver class definition
+ */
+
+#ifndef LINEAR_RESOLVER_H_
+#define LINEAR_RESOLVER_H_
+
+#include <string>
+
+#include "linear/addrinfo.h"
+
+#define RESOLVER_TTL (60000) // 1 min
+
+namespace linear {
+
+// Resolver decides the address that client sockets connect to, without blocking the caller.
+// - a numeric host is used as is, without the resolver
+// - a host name is looked up in a per-process cache of the addresses that sockets connected to,
+//   and is passed to tv_connect as is if not cached, then libtv resolves it asynchronously on the event loop
+// getaddrinfo does not tell the TTL of records, so cached addresses expire RESOLVER_TTL msecs after stored,
+// and are removed when connecting to them fails.
+class Resolver {
+ public:
+  // return true and set proto if host is a numeric IPv4 or IPv6 address
+  static bool IsNumeric(const std::string& host, linear::Addrinfo::Protocol* proto = NULL);
+  // return the numeric or cached address of host, or host itself with linear::Addrinfo::UNKNOWN
+  static linear::Addrinfo Lookup(const std::string& host, int port);
+  // cache the address of host that a socket connected to
+  static void Store(const std::string& host, const linear::Addrinfo& resolved, unsigned int ttl = RESOLVER_TTL);
+  static void Remove(const std::string& host);
+  static void Clear();
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_RESOLVER_H_
@@ -14,14 +14,30 @@ Error Server::SetMaxClients(size_t max_clients) const {
   return Error(LNR_OK);
 }
 
-Error Server::Start(const std::string& host, int port) const {
+Error Server::SetMaxAcceptRate(size_t rate) const {
   if (!server_) {
     return Error(LNR_EINVAL);
   }
+  server_->SetMaxAcceptRate(rate);
+  return Error(LNR_OK);
+}
+
+Error Server::SetExecutor(const Executor& executor) const {
+  if (!server_) {
+    return Error(LNR_EINVAL);
+  }
+  server_->SetExecutor(executor.GetImpl());
+  return Error(LNR_OK);
+}
+
+Error Server::Start(const std::string& host, int port, int backlog) const {
+  if (!server_ || backlog <= 0) {
+    return Error(LNR_EINVAL);
+  }
   Error e(LNR_ENOMEM);
   try {
     EventLoopImpl::ServerEvent* ev = new EventLoopImpl::ServerEvent(server_);
-    e = server_->Start(host, port, ev);
+    e = server_->Start(host, port, backlog, ev);
     if (e != Error(LNR_OK)) {
       delete ev;
     }
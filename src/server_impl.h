@@ -7,7 +7,6 @@ namespace linear {
 
 class ServerImpl : public HandlerDelegate {
  public:
-  static const int BACKLOG = 10; // backlog = 10
   enum State {
     STOP,
     START
@@ -17,9 +16,10 @@ class ServerImpl : public HandlerDelegate {
   ServerImpl(const linear::weak_ptr<linear::Handler>& handler,
              const linear::EventLoop& loop,
              bool show_ssl_version = false)
-    : HandlerDelegate(handler, loop, show_ssl_version), state_(STOP) {}
+    : HandlerDelegate(handler, loop, show_ssl_version), state_(STOP),
+      accept_rate_(0), accept_tokens_(0), accept_refilled_(0) {}
   virtual ~ServerImpl() {}
-  virtual linear::Error Start(const std::string& hostname, int port,
+  virtual linear::Error Start(const std::string& hostname, int port, int backlog,
                               linear::EventLoopImpl::ServerEvent* ev) = 0;
   virtual linear::Error Stop() = 0;
   virtual void Release(const linear::shared_ptr<linear::SocketImpl>& socket) {
@@ -27,11 +27,45 @@ class ServerImpl : public HandlerDelegate {
     HandlerDelegate::Release(socket);
   }
   virtual void OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, int status) = 0;
+  void SetMaxAcceptRate(size_t rate) {
+    linear::lock_guard<linear::mutex> lock(mutex_);
+    accept_rate_ = rate;
+    accept_tokens_ = rate * 1000;
+    accept_refilled_ = uv_hrtime() / 1000000;
+  }
 
  protected:
+  // admission control at accept, called under mutex_ before building a socket.
+  // LNR_ENOSPC if the max clients are connected, or LNR_EAGAIN if over the accept rate.
+  // the rate is limited by a token bucket that holds accept_rate_ connections at most,
+  // and tokens are counted in 1/1000 so that refilling by msec is exact.
+  linear::Error Admit() {
+    if (pool_.IsFull()) {
+      return linear::Error(LNR_ENOSPC);
+    }
+    if (accept_rate_ == 0) {
+      return linear::Error(LNR_OK);
+    }
+    uint64_t now = uv_hrtime() / 1000000;
+    uint64_t limit = static_cast<uint64_t>(accept_rate_) * 1000;
+    accept_tokens_ += (now - accept_refilled_) * accept_rate_;
+    if (accept_tokens_ > limit) {
+      accept_tokens_ = limit;
+    }
+    accept_refilled_ = now;
+    if (accept_tokens_ < 1000) {
+      return linear::Error(LNR_EAGAIN);
+    }
+    accept_tokens_ -= 1000;
+    return linear::Error(LNR_OK);
+  }
+
   linear::ServerImpl::State state_;
   linear::Addrinfo self_;
   linear::mutex mutex_;
+  size_t accept_rate_;       // connections per sec, 0: no limit
+  uint64_t accept_tokens_;   // 1/1000 connections
+  uint64_t accept_refilled_; // msec
 };
 
 }  // namespace linear
@@ -1,4 +1,7 @@
+#include "linear/future.h"
 #include "linear/log.h"
+#include "linear/message.h"
+#include "linear/packed_message.h"
 
 #include "socket_impl.h"
 
@@ -93,6 +96,14 @@ Error Socket::SetMaxRecvBufferSize(size_t limit) const {
   return Error(LNR_OK);
 }
 
+Error Socket::SetWriteCoalescing(bool enable, unsigned int cork_usec) const {
+  if (!socket_) {
+    return Error(LNR_EBADF);
+  }
+  socket_->SetWriteCoalescing(enable, cork_usec);
+  return Error(LNR_OK);
+}
+
 Error Socket::Connect(unsigned int timeout) const {
   if (!socket_) {
     return Error(LNR_EBADF);
@@ -191,4 +202,35 @@ Error Socket::Send(const Message& message, int timeout) const {
   return socket_->Send(message, timeout);
 }
 
+Error Socket::Send(const PackedMessage& message, int timeout) const {
+  if (!socket_) {
+    return Error(LNR_EBADF);
+  }
+  if (!message.GetImpl()) {
+    return Error(LNR_EINVAL);
+  }
+  return socket_->Send(message.GetImpl(), timeout);
+}
+
+Error Socket::Call(const Request& request, int timeout, Response* response) const {
+  if (!socket_) {
+    return Error(LNR_EBADF);
+  }
+  if (response == NULL) {
+    return Error(LNR_EINVAL);
+  }
+  // the response is received on the event loop thread, so waiting there never ends
+  if (socket_->IsLoopThread()) {
+    LINEAR_LOG(LOG_ERR, "fail to call(id = %d): called on the event loop thread of the socket", socket_->GetId());
+    return Error(LNR_EPERM);
+  }
+  Request call(request);
+  Future future = call.SendAsync(*this, timeout);
+  Error err = future.GetError();
+  if (err == Error(LNR_OK)) {
+    *response = future.GetResponse();
+  }
+  return err;
+}
+
 } // namespace linear
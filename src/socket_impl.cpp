@@ -4,6 +4,7 @@
 
 #include "ws_socket_impl.h"
 #include "handler_delegate.h"
+#include "message_decoder.h"
 
 #ifdef WITH_SSL
 # include "linear/wss_socket.h"
@@ -50,20 +51,22 @@ SocketImpl::SocketImpl(const std::string& host, int port,
                        const weak_ptr<HandlerDelegate>& delegate,
                        Socket::Type type)
   : state_(Socket::DISCONNECTED),
-    stream_(NULL), ev_(NULL), peer_(Addrinfo(host, port)), loop_(loop), type_(type), id_(Id()),
+    stream_(NULL), ev_(NULL), peer_(Resolver::Lookup(host, port)), host_(host), loop_(loop), type_(type), id_(Id()),
     connectable_(true), handshaking_(false), last_error_(LNR_OK), delegate_(delegate),
-    connect_timeout_(0), connect_timer_(loop_) {
+    connect_timeout_(0), connect_timer_(loop_),
+    write_coalescing_(false), cork_usec_(0), batch_(NULL), flush_timer_(loop_) {
   SetMaxBufferSize(Socket::DEFAULT_MAX_BUFFER_SIZE);
-  if (peer_.proto == Addrinfo::UNKNOWN) {
-    LINEAR_LOG(LOG_ERR, "fail to create socket(id = %d, type = %s, peer = [%s]:%d, connectable): address not available",
-               id_, GetTypeString(type_).c_str(),
-               host.c_str(), port);
+  // host names are resolved at Connect on the event loop, not here
+  if (host_.empty()) {
+    LINEAR_LOG(LOG_ERR, "fail to create socket(id = %d, type = %s, peer = :%d, connectable): address not available",
+               id_, GetTypeString(type_).c_str(), port);
   } else {
     LINEAR_LOG(LOG_DEBUG, "socket(id = %d, type = %s, peer = %s:%d, connectable) is created",
                id_, GetTypeString(type_).c_str(),
-               (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
+               (peer_.proto == Addrinfo::IPv6) ? (std::string("[" + host_ + "]")).c_str() : host_.c_str(),
                peer_.port);
   }
+  loop_->IncreaseSockets();
 }
 
 // Server Socket
@@ -73,22 +76,23 @@ SocketImpl::SocketImpl(tv_stream_t* stream,
                        Socket::Type type)
   : stream_(stream), ev_(NULL), loop_(loop), type_(type), id_(Id()),
     connectable_(false), last_error_(LNR_OK), delegate_(delegate),
-    connect_timeout_(0), connect_timer_(loop_) {
+    connect_timeout_(0), connect_timer_(loop_),
+    write_coalescing_(false), cork_usec_(0), batch_(NULL), flush_timer_(loop_) {
   if (type == Socket::WS) {
     handshaking_ = true;
-    state_ = Socket::CONNECTING;
+    state_.Store(Socket::CONNECTING);
     reinterpret_cast<tv_ws_t*>(stream_)->handshake_complete_cb = EventLoopImpl::OnAcceptComplete;
 
 #ifdef WITH_SSL
   } else if (type == Socket::WSS) {
     handshaking_ = true;
-    state_ = Socket::CONNECTING;
+    state_.Store(Socket::CONNECTING);
     reinterpret_cast<tv_wss_t*>(stream_)->handshake_complete_cb = EventLoopImpl::OnAcceptComplete;
 #endif
 
   } else {
     handshaking_ = false;
-    state_ = Socket::CONNECTED;
+    state_.Store(Socket::CONNECTED);
   }
   union {
     struct sockaddr_storage ss;
@@ -116,10 +120,28 @@ SocketImpl::SocketImpl(tv_stream_t* stream,
              self_.port,
              (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
              peer_.port);
+  loop_->IncreaseSockets();
 }
 
 SocketImpl::~SocketImpl() {
   Disconnect(false);
+  if (batch_ != NULL) {
+    batch_->pool->Release(batch_);
+  }
+  // requests still waiting for response are never answered, so cancel their futures now
+  // and delete them, that also cancels their deadlines (and waits for a timeout being fired)
+  std::vector<RequestTimer*> request_timers;
+  try {
+    request_timers_.Release(&request_timers);
+  } catch(...) {
+  }
+  for (std::vector<RequestTimer*>::iterator it = request_timers.begin(); it != request_timers.end(); it++) {
+    if ((*it)->request.HasFuture()) {
+      (*it)->request.CompleteFuture(Error(LNR_ECANCELED));
+    }
+    delete *it;
+  }
+  loop_->DecreaseSockets();
   LINEAR_LOG(LOG_DEBUG, "socket(id = %d) is destroyed", id_);
 }
 
@@ -139,25 +161,45 @@ void SocketImpl::SetMaxRecvBufferSize(size_t limit) {
   max_recv_buffer_size_ = limit;
 }
 
+void SocketImpl::SetWriteCoalescing(bool enable, unsigned int cork_usec) {
+  unique_lock<mutex> state_lock(state_mutex_);
+  write_coalescing_ = enable;
+  cork_usec_ = cork_usec;
+  if (enable) {
+    return;
+  }
+  int status = 0;
+  WriteBuffer* failed = _Flush(&status);
+  if (failed == NULL) {
+    return;
+  }
+  shared_ptr<SocketImpl> socket = (ev_ != NULL) ? ev_->socket.lock() : shared_ptr<SocketImpl>();
+  state_lock.unlock();
+  _DiscardWriteBuffer(socket, failed, status);
+}
+
 Error SocketImpl::Connect(unsigned int timeout, EventLoopImpl::SocketEvent* ev) {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (!connectable_ || peer_.proto == Addrinfo::UNKNOWN) {
+  if (!connectable_ || host_.empty()) {
     LINEAR_LOG(LOG_WARN, "this socket(id = %d) is not connectable", id_);
     return Error(LNR_EINVAL);
   }
-  if (state_ == Socket::CONNECTING || state_ == Socket::CONNECTED) {
+  Socket::State state = state_.Load();
+  if (state == Socket::CONNECTING || state == Socket::CONNECTED) {
     LINEAR_LOG(LOG_INFO, "this socket(id = %d) is %s",
                id_,
-               (state_ == Socket::CONNECTING) ? "connecting now" : "already connected");
+               (state == Socket::CONNECTING) ? "connecting now" : "already connected");
     return Error(LNR_EALREADY);
-  } else if (state_ == Socket::DISCONNECTING) {
+  } else if (state == Socket::DISCONNECTING) {
     LINEAR_LOG(LOG_WARN, "this socket(id = %d) is disconnecting now.plz call later.", id_);
     return Error(LNR_EBUSY);
   }
+  // use the cached address if any, or connect to the host name and let libtv resolve it on the event loop
+  peer_ = Resolver::Lookup(host_, peer_.port);
   LINEAR_LOG(LOG_DEBUG, "try to connect(id = %d): --- %s --> %s:%d",
              id_,
              GetTypeString(type_).c_str(),
-             (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
+             (peer_.proto == Addrinfo::IPv6) ? (std::string("[" + peer_.addr + "]")).c_str() : peer_.addr.c_str(),
              peer_.port);
   ev_ = ev;
   Error err;
@@ -173,7 +215,7 @@ Error SocketImpl::Connect(unsigned int timeout, EventLoopImpl::SocketEvent* ev)
   self_ = Addrinfo(); // reset self info
   err = Connect();
   if (err == Error(LNR_OK)) {
-    state_ = Socket::CONNECTING;
+    state_.Store(Socket::CONNECTING);
     if (timeout > 0) {
       connect_timeout_ = timeout;
       connect_timer_.Start(EventLoopImpl::OnConnectTimeout, connect_timeout_, ev_);
@@ -190,21 +232,39 @@ Error SocketImpl::Connect(unsigned int timeout, EventLoopImpl::SocketEvent* ev)
 }
 
 Error SocketImpl::Disconnect(bool handshaking) {
-  lock_guard<mutex> state_lock(state_mutex_);
+  unique_lock<mutex> state_lock(state_mutex_);
   handshaking_ = handshaking;
-  if (state_ == Socket::DISCONNECTING || state_ == Socket::DISCONNECTED) {
+  Socket::State state = state_.Load();
+  if (state == Socket::DISCONNECTING || state == Socket::DISCONNECTED) {
     return Error(LNR_EALREADY);
   }
   connect_timer_.Stop();
-  state_ = Socket::DISCONNECTING;
+  // write gathered messages before closing, as if they were written one by one
+  int status = 0;
+  WriteBuffer* failed = _Flush(&status);
+  shared_ptr<SocketImpl> socket;
+  if (failed != NULL && ev_ != NULL) {
+    socket = ev_->socket.lock();
+  }
+  state_.Store(Socket::DISCONNECTING);
   last_error_ = Error(LNR_OK);
   tv_close(reinterpret_cast<tv_handle_t*>(stream_), EventLoopImpl::OnClose);
+  state_lock.unlock();
+  if (failed != NULL) {
+    _DiscardWriteBuffer(socket, failed, status);
+  }
   return Error(LNR_OK);
 }
 
-Error SocketImpl::Send(const Message& message, int timeout) {
-  lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ == Socket::DISCONNECTING || state_ == Socket::DISCONNECTED) {
+Error SocketImpl::Send(const Message& message, int timeout, const PackedMessageImpl* packed) {
+  // fail fast without the lock, and check again under the lock
+  Socket::State state = state_.Load();
+  if (state == Socket::DISCONNECTING || state == Socket::DISCONNECTED) {
+    return Error(LNR_ENOTCONN);
+  }
+  unique_lock<mutex> state_lock(state_mutex_);
+  state = state_.Load();
+  if (state == Socket::DISCONNECTING || state == Socket::DISCONNECTED) {
     return Error(LNR_ENOTCONN);
   }
   try {
@@ -214,6 +274,10 @@ Error SocketImpl::Send(const Message& message, int timeout) {
       {
         Request* copy_request = new Request(static_cast<const Request&>(message));
         copy_request->timeout_ = timeout;
+        if (packed != NULL) {
+          // packed Request is sent with a new msgid everytime
+          copy_request->msgid = GenerateMsgid();
+        }
         copy_message = copy_request;
       }
       break;
@@ -227,13 +291,23 @@ Error SocketImpl::Send(const Message& message, int timeout) {
       LINEAR_LOG(LOG_ERR, "invalid type of message: %d", message.type);
       throw std::bad_typeid();
     }
-    if (state_ == Socket::CONNECTING) {
+    if (state == Socket::CONNECTING) {
       pending_messages_.push_back(copy_message);
       return Error(LNR_OK);
     }
-    Error err = _Send(copy_message);
+    Error err = _Send(copy_message, packed);
     if (err != Error(LNR_OK)) {
       delete copy_message;
+      return err;
+    }
+    if (batch_ != NULL && batch_->size() >= COALESCING_FLUSH_SIZE) {
+      int status = 0;
+      WriteBuffer* failed = _Flush(&status);
+      if (failed != NULL) {
+        shared_ptr<SocketImpl> socket = ev_->socket.lock();
+        state_lock.unlock();
+        _DiscardWriteBuffer(socket, failed, status);
+      }
     }
     return err;
   } catch(const std::bad_typeid&) {
@@ -243,9 +317,42 @@ Error SocketImpl::Send(const Message& message, int timeout) {
   }
 }
 
+Error SocketImpl::Send(const shared_ptr<PackedMessageImpl>& packed, int timeout) {
+  assert(packed);
+  if (packed->GetMessage().type == REQUEST) {
+    // copy Request to wait for the response, and copy packed data to patch msgid
+    return Send(packed->GetMessage(), timeout, packed.get());
+  }
+  Socket::State state = state_.Load();
+  if (state == Socket::DISCONNECTING || state == Socket::DISCONNECTED) {
+    return Error(LNR_ENOTCONN);
+  }
+  unique_lock<mutex> state_lock(state_mutex_);
+  state = state_.Load();
+  if (state == Socket::DISCONNECTING || state == Socket::DISCONNECTED) {
+    return Error(LNR_ENOTCONN);
+  }
+  if (state == Socket::CONNECTING) {
+    // rare case, pending messages are packed again after connected
+    state_lock.unlock();
+    return Send(packed->GetMessage(), 0);
+  }
+  Error err = _Send(packed);
+  if (err == Error(LNR_OK) && batch_ != NULL && batch_->size() >= COALESCING_FLUSH_SIZE) {
+    int status = 0;
+    WriteBuffer* failed = _Flush(&status);
+    if (failed != NULL) {
+      shared_ptr<SocketImpl> socket = ev_->socket.lock();
+      state_lock.unlock();
+      _DiscardWriteBuffer(socket, failed, status);
+    }
+  }
+  return err;
+}
+
 Error SocketImpl::KeepAlive(unsigned int interval, unsigned int retry, Socket::KeepAliveType type) {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTING && state_ != Socket::CONNECTED) {
+  if (state_.Load() != Socket::CONNECTING && state_.Load() != Socket::CONNECTED) {
     return Error(LNR_ENOTCONN);
   }
   if (type == Socket::KEEPALIVE_WS && (type_ == Socket::WS || type_ == Socket::WSS)) {
@@ -274,7 +381,7 @@ Error SocketImpl::BindToDevice(const std::string& ifname) {
 
 Error SocketImpl::SetSockOpt(int level, int optname, const void* optval, size_t optlen) {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTING && state_ != Socket::CONNECTED) {
+  if (state_.Load() != Socket::CONNECTING && state_.Load() != Socket::CONNECTED) {
     return Error(LNR_ENOTCONN);
   }
   int ret = tv_setsockopt(stream_, level, optname, optval, optlen);
@@ -308,10 +415,11 @@ Error SocketImpl::StartRead(EventLoopImpl::SocketEvent* ev) {
 void SocketImpl::OnConnect(const shared_ptr<SocketImpl>& socket, tv_stream_t* stream, int status) {
   unique_lock<mutex> state_lock(state_mutex_);
   connect_timer_.Stop();
-  if (state_ == Socket::CONNECTED) {
+  Socket::State state = state_.Load();
+  if (state == Socket::CONNECTED) {
     return;
   }
-  if (state_ != Socket::CONNECTING) {
+  if (state != Socket::CONNECTING) {
     LINEAR_LOG(LOG_DEBUG, "connect(id = %d) is cancelled: x-- %s --> %s:%d",
                id_,
                GetTypeString(type_).c_str(),
@@ -320,7 +428,9 @@ void SocketImpl::OnConnect(const shared_ptr<SocketImpl>& socket, tv_stream_t* st
     return;
   }
   if (status) {
-    state_ = Socket::DISCONNECTING;
+    state_.Store(Socket::DISCONNECTING);
+    // the cached address may be stale
+    Resolver::Remove(host_);
     if (status == TV_EWS) {
       last_error_ = Error(LNR_EWS); // TODO: detail code
     } else {
@@ -356,6 +466,12 @@ void SocketImpl::OnConnect(const shared_ptr<SocketImpl>& socket, tv_stream_t* st
   if (ret == 0) {
     self_ = Addrinfo(&addr.sa);
   }
+  len = sizeof(addr);
+  ret = tv_getpeername(stream_, &addr.sa, &len);
+  if (ret == 0) {
+    peer_ = Addrinfo(&addr.sa);
+    Resolver::Store(host_, peer_);
+  }
   SetMaxSendBufferSize(max_send_buffer_size_);
   // OK.starts to read
   last_error_ = StartRead(ev_);
@@ -375,11 +491,8 @@ void SocketImpl::OnConnect(const shared_ptr<SocketImpl>& socket, tv_stream_t* st
   if (shared_ptr<HandlerDelegate> delegate = delegate_.lock()) {
     delegate->OnConnect(socket);
   }
-  state_lock.lock();
-  if (state_ == Socket::CONNECTING) {
-    state_ = Socket::CONNECTED;
-  }
-  state_lock.unlock();
+  // fails if disconnected in OnConnect
+  state_.CompareExchange(Socket::CONNECTING, Socket::CONNECTED);
   _SendPendingMessages(socket);
 }
 
@@ -391,7 +504,7 @@ void SocketImpl::OnHandshakeComplete(const shared_ptr<SocketImpl>& socket, tv_st
     return;
   }
   handshaking_ = false;
-  state_ = Socket::CONNECTED;
+  state_.Store(Socket::CONNECTED);
   state_lock.unlock();
   _SendPendingMessages(socket);
 }
@@ -399,7 +512,7 @@ void SocketImpl::OnHandshakeComplete(const shared_ptr<SocketImpl>& socket, tv_st
 void SocketImpl::OnDisconnect(const shared_ptr<SocketImpl>& socket) {
   unique_lock<mutex> state_lock(state_mutex_);
   connect_timer_.Stop();
-  if (state_ == Socket::DISCONNECTED) {
+  if (state_.Load() == Socket::DISCONNECTED) {
     return;
   }
   LINEAR_LOG(LOG_DEBUG, "disconnected(id = %d): %s:%d x-- %s --x %s:%d",
@@ -409,7 +522,7 @@ void SocketImpl::OnDisconnect(const shared_ptr<SocketImpl>& socket) {
              GetTypeString(type_).c_str(),
              (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
              peer_.port);
-  state_ = Socket::DISCONNECTED;
+  state_.Store(Socket::DISCONNECTED);
   state_lock.unlock();
   shared_ptr<HandlerDelegate> delegate = delegate_.lock();
   if (delegate) {
@@ -477,27 +590,15 @@ void SocketImpl::OnDisconnect(const shared_ptr<SocketImpl>& socket) {
   return;
 }
 
-class _Response : public Message {
- public:
-  _Response() : Message(linear::RESPONSE), msgid(0) {}
-  ~_Response() {}
-
- public:
-  uint32_t msgid;
-  linear::type::any result;
-  linear::type::any error;
-  MSGPACK_DEFINE(type, msgid, error, result);
-};
-
+// called on the event loop thread only, so reading state_ needs no lock
 void SocketImpl::OnRead(const shared_ptr<SocketImpl>& socket, const tv_buf_t* buffer, ssize_t nread) {
-  unique_lock<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTING && state_ != Socket::CONNECTED) {
+  Socket::State state = state_.Load();
+  if (state != Socket::CONNECTING && state != Socket::CONNECTED) {
     if (nread > 0) {
       free(buffer->base);
     }
     return;
   }
-  state_lock.unlock();
 
   Error e(nread);
 #ifdef WITH_SSL
@@ -522,87 +623,43 @@ void SocketImpl::OnRead(const shared_ptr<SocketImpl>& socket, const tv_buf_t* bu
     return;
   }
   // nread > 0
-  unpacker_.reserve_buffer(nread);
-  memcpy(unpacker_.buffer(), buffer->base, nread);
-  free(buffer->base);
-  unpacker_.buffer_consumed(nread);
+  // libtv allocates the buffer for each read, so decode complete messages in it as is
+  // while no partial message is left in unpacker, and pass only an incomplete tail to unpacker.
+  // (msgpack::unpack copies str and bin to its zone, so the buffer can be freed at once)
+  char* base = buffer->base;
   shared_ptr<HandlerDelegate> delegate = delegate_.lock();
   try {
-    msgpack::object_handle result;
-    while (unpacker_.next(result)) {
-      msgpack::object obj = result.get();
-      Message message = obj.as<Message>();
-      switch(message.type) {
-      case REQUEST:
-        {
-          Request request = obj.as<Request>();
-          LINEAR_LOG(LOG_DEBUG, "recv request(id = %d): msgid = %u, method = \"%s\", params = %s, %s:%d <-- %s --- %s:%d",
-                     id_, request.msgid,
-                     request.method.c_str(), LINEAR_LOG_PRINTABLE_STRING(request.params).c_str(),
-                     (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
-                     self_.port,
-                     GetTypeString(type_).c_str(),
-                     (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
-                     peer_.port);
-          if (delegate) {
-            delegate->OnMessage(socket, request);
-          }
-        }
-        break;
-      case RESPONSE:
-        {
-          _Response _response = obj.as<_Response>();
-          LINEAR_LOG(LOG_DEBUG, "recv response(id = %d): msgid = %u, result = %s, error = %s, %s:%d <-- %s --- %s:%d",
-                     id_, _response.msgid,
-                     LINEAR_LOG_PRINTABLE_STRING(_response.result).c_str(),
-                     LINEAR_LOG_PRINTABLE_STRING(_response.error).c_str(),
-                     (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
-                     self_.port,
-                     GetTypeString(type_).c_str(),
-                     (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
-                     peer_.port);
-          unique_lock<mutex> request_timer_lock(request_timer_mutex_);
-          for (std::vector<SocketImpl::RequestTimer*>::iterator it = request_timers_.begin();
-               it != request_timers_.end(); it++) {
-            const Request& request = (*it)->request;
-            if (request.msgid == _response.msgid) {
-              Response response(_response.msgid, _response.result, _response.error, request);
-              delete *it;
-              request_timers_.erase(it);
-              request_timer_lock.unlock();
-              if (delegate) {
-                delegate->OnMessage(socket, response);
-              }
-              break;
-            }
-          }
-        }
-        break;
-      case NOTIFY:
-        {
-          Notify notify = obj.as<Notify>();
-          LINEAR_LOG(LOG_DEBUG, "recv notify(id = %d): method = \"%s\", params = %s, %s:%d <-- %s --- %s:%d",
-                     id_,
-                     notify.method.c_str(), LINEAR_LOG_PRINTABLE_STRING(notify.params).c_str(),
-                     (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
-                     self_.port,
-                     GetTypeString(type_).c_str(),
-                     (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
-                     peer_.port);
-          if (delegate) {
-            delegate->OnMessage(socket, notify);
-          }
+    size_t size = static_cast<size_t>(nread);
+    size_t offset = 0;
+    if (unpacker_.nonparsed_size() == 0) {
+      msgpack::object_handle result;
+      while (offset < size) {
+        size_t next = offset;
+        try {
+          msgpack::unpack(result, base, size, next);
+        } catch (const msgpack::insufficient_bytes&) {
           break;
         }
-        break;
-      default:
-        throw std::bad_cast();
+        offset = next;
+        _DispatchMessage(socket, delegate, result);
       }
     }
+    if (offset < size) {
+      unpacker_.reserve_buffer(size - offset);
+      memcpy(unpacker_.buffer(), base + offset, size - offset);
+      unpacker_.buffer_consumed(size - offset);
+    }
+    free(base);
+    base = NULL;
+    msgpack::object_handle result;
+    while (unpacker_.next(result)) {
+      _DispatchMessage(socket, delegate, result);
+    }
     if (unpacker_.message_size() > max_recv_buffer_size_) {
       throw std::runtime_error("");
     }
   } catch (const std::bad_cast&) {
+    free(base);
     LINEAR_LOG(LOG_WARN, "recv invalid message(id = %d): %s:%d <-- %s -- %s:%d",
                id_,
                (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
@@ -612,6 +669,7 @@ void SocketImpl::OnRead(const shared_ptr<SocketImpl>& socket, const tv_buf_t* bu
                peer_.port);
     Disconnect();
   } catch (...) {
+    free(base);
     LINEAR_LOG(LOG_ERR, "recv malformed or big message(id = %d): %s:%d <-- %s -- %s:%d",
                id_,
                (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
@@ -623,180 +681,380 @@ void SocketImpl::OnRead(const shared_ptr<SocketImpl>& socket, const tv_buf_t* bu
   }
 }
 
-void SocketImpl::OnWrite(const shared_ptr<SocketImpl>& socket, const Message* message, int status) {
-  assert(message != NULL);
-  if (status) {
-    LINEAR_LOG(LOG_ERR, "fail to send message(id = %d): %s",
-               id_,
-               tv_strerror(reinterpret_cast<tv_handle_t*>(stream_), status));
-    if (shared_ptr<HandlerDelegate> delegate = delegate_.lock()) {
-      switch(message->type) {
-      case REQUEST:
-	{
-	  linear::Request request_fail = *(static_cast<const Request*>(message));
-	  unique_lock<mutex> request_timer_lock(request_timer_mutex_);
-	  for (std::vector<SocketImpl::RequestTimer*>::iterator it = request_timers_.begin();
-	       it != request_timers_.end(); it++) {
-	    const Request& request = (*it)->request;
-	    if (request.msgid == request_fail.msgid) {
-	      delete *it;
-	      request_timers_.erase(it);
-	      request_timer_lock.unlock();
-	      break;
-	    }
-	  }
-	  delegate->OnError(socket, request_fail, Error(status));
-	}
-        break;
-      case RESPONSE:
-        delegate->OnError(socket, *(static_cast<const Response*>(message)), Error(status));
-        break;
-      case NOTIFY:
-        delegate->OnError(socket, *(static_cast<const Notify*>(message)), Error(status));
-        break;
-      default:
-        LINEAR_LOG(LOG_ERR, "BUG: invalid type of message");
-        assert(false);
-      }
-    }
-  }
-}
-
-void SocketImpl::OnConnectTimeout(const shared_ptr<SocketImpl>& socket) {
-  OnConnect(socket, stream_, TV_ETIMEDOUT);
-}
-
-void SocketImpl::OnRequestTimeout(const shared_ptr<SocketImpl>& socket, const Request& request) {
-  unique_lock<mutex> request_timer_lock(request_timer_mutex_);
-  for (std::vector<SocketImpl::RequestTimer*>::iterator it = request_timers_.begin();
-       it != request_timers_.end(); it++) {
-    const Request& ref = (*it)->request;
-    if (ref.msgid == request.msgid) {
-      LINEAR_LOG(LOG_INFO, "occur request timeout(id = %d): msgid = %d",
-                 id_, request.msgid);
-      request_timers_.erase(it);
-      break;
-    }
-  }
-  request_timer_lock.unlock();
-  if (shared_ptr<HandlerDelegate> delegate = delegate_.lock()) {
-    delegate->OnError(socket, request, Error(LNR_ETIMEDOUT));
-  }
-}
-
-Error SocketImpl::_Send(Message* message) {
-  assert(message != NULL);
-  RequestTimer* request_timer = NULL;
-  msgpack::sbuffer sbuf;
-  switch(message->type) {
+void SocketImpl::_DispatchMessage(const shared_ptr<SocketImpl>& socket,
+                                  const shared_ptr<HandlerDelegate>& delegate,
+                                  msgpack::object_handle& handle) {
+  switch(MessageDecoder::GetType(handle.get())) {
   case REQUEST:
     {
-      const Request* request = static_cast<const Request*>(message);
-      LINEAR_LOG(LOG_DEBUG, "send request(id = %d): msgid = %u, method = \"%s\", params = %s, %s:%d --- %s --> %s:%d",
-                 id_,
-                 request->msgid, request->method.c_str(), LINEAR_LOG_PRINTABLE_STRING(request->params).c_str(),
+      Request request;
+      MessageDecoder::Decode(handle, &request);
+      LINEAR_LOG(LOG_DEBUG, "recv request(id = %d): msgid = %u, method = \"%s\", params = %s, %s:%d <-- %s --- %s:%d",
+                 id_, request.msgid,
+                 request.method.c_str(), LINEAR_LOG_PRINTABLE_STRING(request.params).c_str(),
                  (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
                  self_.port,
                  GetTypeString(type_).c_str(),
                  (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
                  peer_.port);
-      msgpack::pack(sbuf, *request);
-      try {
-	request_timer = new RequestTimer(*request, ev_->socket, loop_);
-      } catch(...) {
-	Error err(LNR_ENOMEM);
-	LINEAR_LOG(LOG_ERR, "fail to send message(id = %d): %s",
-		   id_, err.Message().c_str());
-	return err;
+      if (delegate) {
+        delegate->OnMessage(socket, request);
       }
-      break;
     }
+    break;
   case RESPONSE:
     {
-      const Response* response = static_cast<const Response*>(message);
-      LINEAR_LOG(LOG_DEBUG, "send response(id = %d): msgid = %u, result = %s, error = %s, %s:%d --- %s --> %s:%d",
-                 id_,
-                 response->msgid,
-                 LINEAR_LOG_PRINTABLE_STRING(response->result).c_str(),
-                 LINEAR_LOG_PRINTABLE_STRING(response->error).c_str(),
+      Response response;
+      MessageDecoder::Decode(handle, &response);
+      LINEAR_LOG(LOG_DEBUG, "recv response(id = %d): msgid = %u, result = %s, error = %s, %s:%d <-- %s --- %s:%d",
+                 id_, response.msgid,
+                 LINEAR_LOG_PRINTABLE_STRING(response.result).c_str(),
+                 LINEAR_LOG_PRINTABLE_STRING(response.error).c_str(),
                  (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
                  self_.port,
                  GetTypeString(type_).c_str(),
                  (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
                  peer_.port);
-      msgpack::pack(sbuf, *response);
-      break;
+      unique_lock<mutex> request_timer_lock(request_timer_mutex_);
+      RequestTimer* request_timer = request_timers_.Remove(response.msgid);
+      request_timer_lock.unlock();
+      if (request_timer != NULL) {
+        // request_timer is no longer used, so hand over the request without copying
+        response.request.swap(request_timer->request);
+        delete request_timer;
+        if (delegate) {
+          delegate->OnMessage(socket, response);
+        }
+      }
     }
+    break;
   case NOTIFY:
     {
-      const Notify* notify = static_cast<const Notify*>(message);
-      LINEAR_LOG(LOG_DEBUG, "send notify(id = %d): method = \"%s\", params = %s, %s:%d --- %s --> %s:%d",
+      Notify notify;
+      MessageDecoder::Decode(handle, &notify);
+      LINEAR_LOG(LOG_DEBUG, "recv notify(id = %d): method = \"%s\", params = %s, %s:%d <-- %s --- %s:%d",
                  id_,
-                 notify->method.c_str(), LINEAR_LOG_PRINTABLE_STRING(notify->params).c_str(),
+                 notify.method.c_str(), LINEAR_LOG_PRINTABLE_STRING(notify.params).c_str(),
                  (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
                  self_.port,
                  GetTypeString(type_).c_str(),
                  (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
                  peer_.port);
-      msgpack::pack(sbuf, *notify);
+      if (delegate) {
+        delegate->OnMessage(socket, notify);
+      }
       break;
     }
+    break;
   default:
-    LINEAR_LOG(LOG_ERR, "invalid type of message: %d", message->type);
-    return Error(LNR_EINVAL);
+    throw std::bad_cast();
+  }
+}
+
+void SocketImpl::OnWrite(const shared_ptr<SocketImpl>& socket, const WriteBuffer* buffer, int status) {
+  assert(buffer != NULL);
+  if (!status) {
+    return;
+  }
+  LINEAR_LOG(LOG_ERR, "fail to send message(id = %d): %s",
+             id_,
+             tv_strerror(reinterpret_cast<tv_handle_t*>(stream_), status));
+  for (std::vector<Message*>::const_iterator it = buffer->messages.begin();
+       it != buffer->messages.end(); it++) {
+    _OnWriteError(socket, **it, status);
+  }
+  for (std::vector<shared_ptr<PackedMessageImpl> >::const_iterator it = buffer->packs.begin();
+       it != buffer->packs.end(); it++) {
+    _OnWriteError(socket, (*it)->GetMessage(), status);
+  }
+}
+
+void SocketImpl::OnConnectTimeout(const shared_ptr<SocketImpl>& socket) {
+  OnConnect(socket, stream_, TV_ETIMEDOUT);
+}
+
+void SocketImpl::OnFlushTimeout(const shared_ptr<SocketImpl>& socket) {
+  unique_lock<mutex> state_lock(state_mutex_);
+  int status = 0;
+  WriteBuffer* failed = _Flush(&status);
+  state_lock.unlock();
+  if (failed != NULL) {
+    _DiscardWriteBuffer(socket, failed, status);
+  }
+}
+
+void SocketImpl::OnRequestTimeout(const shared_ptr<SocketImpl>& socket, RequestTimer* request_timer) {
+  unique_lock<mutex> request_timer_lock(request_timer_mutex_);
+  if (request_timers_.Find(request_timer->request.msgid) != request_timer) {
+    // already answered or cancelled, and deleted by the one who unregistered it
+    return;
   }
-  char* copy_data = static_cast<char*>(malloc(sbuf.size()));
-  if (copy_data == NULL) {
+  request_timers_.Remove(request_timer->request.msgid);
+  request_timer_lock.unlock();
+  LINEAR_LOG(LOG_INFO, "occur request timeout(id = %d): msgid = %d",
+             id_, request_timer->request.msgid);
+  if (shared_ptr<HandlerDelegate> delegate = delegate_.lock()) {
+    delegate->OnError(socket, request_timer->request, Error(LNR_ETIMEDOUT));
+  }
+  delete request_timer;
+}
+
+Error SocketImpl::_Send(Message* message, const PackedMessageImpl* packed) {
+  assert(message != NULL);
+  // the request timer is owned by request_timers_ once registered, and may be deleted by others at any time,
+  // so it is referred only by msgid from here
+  bool registered = false;
+  uint32_t msgid = 0;
+  WriteBuffer* buffer = batch_;
+  size_t offset = 0;
+  try {
+    if (buffer == NULL) {
+      buffer = loop_->GetWriteBufferPool().Acquire();
+    }
+    offset = buffer->size();
+    switch(message->type) {
+    case REQUEST:
+      {
+        const Request* request = static_cast<const Request*>(message);
+        LINEAR_LOG(LOG_DEBUG, "send request(id = %d): msgid = %u, method = \"%s\", params = %s, %s:%d --- %s --> %s:%d",
+                   id_,
+                   request->msgid, request->method.c_str(), LINEAR_LOG_PRINTABLE_STRING(request->params).c_str(),
+                   (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
+                   self_.port,
+                   GetTypeString(type_).c_str(),
+                   (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
+                   peer_.port);
+        if (packed != NULL) {
+          buffer->write(packed->data(), packed->size());
+          PackedMessageImpl::PatchMsgid(buffer->data() + offset, request->msgid);
+        } else {
+          msgpack::pack(*buffer, *request);
+        }
+        RequestTimer* request_timer = new RequestTimer(*request, ev_->socket, loop_);
+        // registered and started before written, so that a response never overtakes it
+        unique_lock<mutex> request_timer_lock(request_timer_mutex_);
+        registered = request_timers_.Insert(request->msgid, request_timer);
+        if (registered) {
+          msgid = request->msgid;
+          request_timer->Start();
+        }
+        request_timer_lock.unlock();
+        if (!registered) {
+          LINEAR_LOG(LOG_ERR, "fail to send request(id = %d): msgid = %u is already waiting for response",
+                     id_, request->msgid);
+          delete request_timer;
+          if (buffer == batch_) {
+            buffer->Truncate(offset);
+          } else {
+            buffer->pool->Release(buffer);
+          }
+          return Error(LNR_EALREADY);
+        }
+        break;
+      }
+    case RESPONSE:
+      {
+        const Response* response = static_cast<const Response*>(message);
+        LINEAR_LOG(LOG_DEBUG, "send response(id = %d): msgid = %u, result = %s, error = %s, %s:%d --- %s --> %s:%d",
+                   id_,
+                   response->msgid,
+                   LINEAR_LOG_PRINTABLE_STRING(response->result).c_str(),
+                   LINEAR_LOG_PRINTABLE_STRING(response->error).c_str(),
+                   (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
+                   self_.port,
+                   GetTypeString(type_).c_str(),
+                   (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
+                   peer_.port);
+        msgpack::pack(*buffer, *response);
+        break;
+      }
+    case NOTIFY:
+      {
+        const Notify* notify = static_cast<const Notify*>(message);
+        LINEAR_LOG(LOG_DEBUG, "send notify(id = %d): method = \"%s\", params = %s, %s:%d --- %s --> %s:%d",
+                   id_,
+                   notify->method.c_str(), LINEAR_LOG_PRINTABLE_STRING(notify->params).c_str(),
+                   (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
+                   self_.port,
+                   GetTypeString(type_).c_str(),
+                   (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
+                   peer_.port);
+        msgpack::pack(*buffer, *notify);
+        break;
+      }
+    default:
+      LINEAR_LOG(LOG_ERR, "invalid type of message: %d", message->type);
+      if (buffer != batch_) {
+        buffer->pool->Release(buffer);
+      }
+      return Error(LNR_EINVAL);
+    }
+    // the message is owned by the buffer from here, and deleted when the buffer is released
+    buffer->messages.push_back(message);
+  } catch(...) {
     Error err(LNR_ENOMEM);
     LINEAR_LOG(LOG_ERR, "fail to send message(id = %d): %s",
                id_, err.Message().c_str());
-    if (request_timer != NULL) {
-      delete request_timer;
+    if (buffer == batch_) {
+      buffer->Truncate(offset);
+    } else if (buffer != NULL) {
+      buffer->pool->Release(buffer);
+    }
+    if (registered) {
+      _CancelRequestTimer(msgid);
     }
     return err;
   }
-  memcpy(copy_data, sbuf.data(), sbuf.size());
-  tv_buf_t buffer = static_cast<tv_buf_t>(uv_buf_init(copy_data, sbuf.size()));
-  tv_write_t* w = static_cast<tv_write_t*>(malloc(sizeof(tv_write_t)));
-  if (w == NULL) {
+  if (buffer == batch_ ||
+      (write_coalescing_ &&
+       flush_timer_.Start(EventLoopImpl::OnFlushTimeout, (cork_usec_ + 999) / 1000, ev_) == Error(LNR_OK))) {
+    // gathered, and written at OnFlushTimeout
+    batch_ = buffer;
+  } else {
+    tv_buf_t tv_buffer = static_cast<tv_buf_t>(uv_buf_init(buffer->data(), buffer->size()));
+    int ret = tv_write(&buffer->request, stream_, tv_buffer, EventLoopImpl::OnWrite);
+    if (ret) { // EINVAL or ENOMEM
+      Error err(ret);
+      buffer->messages.clear(); // caller deletes the message
+      buffer->pool->Release(buffer);
+      if (registered) {
+        _CancelRequestTimer(msgid);
+      }
+      LINEAR_LOG(LOG_ERR, "fail to send message(id = %d): %s",
+                 id_, err.Message().c_str());
+      return err;
+    }
+  }
+  return Error(LNR_OK);
+}
+
+// unregister and delete a request timer of a request failed to send,
+// unless it has been already unregistered (by timeout) and deleted by the one who did it
+void SocketImpl::_CancelRequestTimer(uint32_t msgid) {
+  unique_lock<mutex> request_timer_lock(request_timer_mutex_);
+  RequestTimer* request_timer = request_timers_.Remove(msgid);
+  request_timer_lock.unlock();
+  delete request_timer;
+}
+
+// write a message packed beforehand (state_mutex_ must be locked)
+// the packed data is referred as is, or copied when gathered with other messages
+Error SocketImpl::_Send(const shared_ptr<PackedMessageImpl>& packed) {
+  LINEAR_LOG(LOG_DEBUG, "send packed message(id = %d): type = %d, size = %lu, %s:%d --- %s --> %s:%d",
+             id_,
+             packed->GetMessage().type, static_cast<unsigned long>(packed->size()),
+             (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
+             self_.port,
+             GetTypeString(type_).c_str(),
+             (peer_.proto == Addrinfo::IPv4) ? peer_.addr.c_str() : (std::string("[" + peer_.addr + "]")).c_str(),
+             peer_.port);
+  WriteBuffer* buffer = batch_;
+  bool gather = (batch_ != NULL || write_coalescing_);
+  size_t offset = 0;
+  try {
+    if (buffer == NULL) {
+      buffer = loop_->GetWriteBufferPool().Acquire();
+    }
+    offset = buffer->size();
+    if (gather) {
+      buffer->write(packed->data(), packed->size());
+    }
+    buffer->packs.push_back(packed);
+  } catch(...) {
     Error err(LNR_ENOMEM);
     LINEAR_LOG(LOG_ERR, "fail to send message(id = %d): %s",
                id_, err.Message().c_str());
-    free(copy_data);
-    if (request_timer != NULL) {
-      delete request_timer;
+    if (buffer == batch_) {
+      buffer->Truncate(offset);
+    } else if (buffer != NULL) {
+      buffer->pool->Release(buffer);
     }
     return err;
   }
-  w->data = message;
-  int ret = tv_write(w, stream_, buffer, EventLoopImpl::OnWrite);
+  if (buffer == batch_ ||
+      (write_coalescing_ &&
+       flush_timer_.Start(EventLoopImpl::OnFlushTimeout, (cork_usec_ + 999) / 1000, ev_) == Error(LNR_OK))) {
+    // gathered, and written at OnFlushTimeout
+    batch_ = buffer;
+    return Error(LNR_OK);
+  }
+  char* data = gather ? buffer->data() : const_cast<char*>(packed->data());
+  tv_buf_t tv_buffer = static_cast<tv_buf_t>(uv_buf_init(data, packed->size()));
+  int ret = tv_write(&buffer->request, stream_, tv_buffer, EventLoopImpl::OnWrite);
   if (ret) { // EINVAL or ENOMEM
     Error err(ret);
-    free(w);
-    free(copy_data);
-    if (request_timer != NULL) {
-      delete request_timer;
-    }
+    buffer->pool->Release(buffer);
     LINEAR_LOG(LOG_ERR, "fail to send message(id = %d): %s",
                id_, err.Message().c_str());
     return err;
   }
-  if (request_timer != NULL) {
-    unique_lock<mutex> request_timer_lock(request_timer_mutex_);
-    request_timers_.push_back(request_timer);
-    request_timer_lock.unlock();
-    request_timer->Start();
-  }
   return Error(LNR_OK);
 }
 
+// write messages gathered by write coalescing at once (state_mutex_ must be locked)
+// returns the buffer failed to write, that must be discarded after state_mutex_ is unlocked
+WriteBuffer* SocketImpl::_Flush(int* status) {
+  assert(status != NULL);
+  flush_timer_.Stop();
+  WriteBuffer* buffer = batch_;
+  if (buffer == NULL) {
+    return NULL;
+  }
+  batch_ = NULL;
+  tv_buf_t tv_buffer = static_cast<tv_buf_t>(uv_buf_init(buffer->data(), buffer->size()));
+  int ret = tv_write(&buffer->request, stream_, tv_buffer, EventLoopImpl::OnWrite);
+  if (ret) { // EINVAL or ENOMEM
+    LINEAR_LOG(LOG_ERR, "fail to send messages(id = %d): %s",
+               id_, Error(ret).Message().c_str());
+    *status = ret;
+    return buffer;
+  }
+  return NULL;
+}
+
+void SocketImpl::_DiscardWriteBuffer(const shared_ptr<SocketImpl>& socket, WriteBuffer* buffer, int status) {
+  assert(buffer != NULL);
+  if (socket) {
+    OnWrite(socket, buffer, status);
+  }
+  buffer->pool->Release(buffer);
+}
+
+void SocketImpl::_OnWriteError(const shared_ptr<SocketImpl>& socket, const Message& message, int status) {
+  shared_ptr<HandlerDelegate> delegate = delegate_.lock();
+  if (!delegate) {
+    return;
+  }
+  switch(message.type) {
+  case REQUEST:
+    {
+      const Request& request_fail = static_cast<const Request&>(message);
+      unique_lock<mutex> request_timer_lock(request_timer_mutex_);
+      RequestTimer* request_timer = request_timers_.Remove(request_fail.msgid);
+      request_timer_lock.unlock();
+      delete request_timer;
+      delegate->OnError(socket, request_fail, Error(status));
+    }
+    break;
+  case RESPONSE:
+    delegate->OnError(socket, static_cast<const Response&>(message), Error(status));
+    break;
+  case NOTIFY:
+    delegate->OnError(socket, static_cast<const Notify&>(message), Error(status));
+    break;
+  default:
+    LINEAR_LOG(LOG_ERR, "BUG: invalid type of message");
+    assert(false);
+  }
+}
+
 void SocketImpl::_SendPendingMessages(const shared_ptr<SocketImpl>& socket) {
   unique_lock<mutex> state_lock(state_mutex_);
   // Send pending messages
   std::vector<Message*> fail_to_send;
   for (std::vector<Message*>::iterator it = pending_messages_.begin();
        it != pending_messages_.end(); it++) {
-    if (state_ != Socket::CONNECTED) {
+    if (state_.Load() != Socket::CONNECTED) {
       fail_to_send.push_back(*it);
     } else {
       Error err = _Send(*it);
@@ -862,7 +1120,11 @@ void SocketImpl::_DiscardMessages(const shared_ptr<SocketImpl>& socket) {
 
   std::vector<RequestTimer*> cancelled_requests;
   unique_lock<mutex> request_timer_lock(request_timer_mutex_);
-  cancelled_requests.swap(request_timers_);
+  try {
+    request_timers_.Release(&cancelled_requests);
+  } catch(...) {
+    LINEAR_LOG(LOG_ERR, "fail to cancel requests(id = %d): no memory", id_);
+  }
   request_timer_lock.unlock();
   for (std::vector<RequestTimer*>::iterator it = cancelled_requests.begin();
        it != cancelled_requests.end(); it++) {
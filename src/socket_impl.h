@@ -5,7 +5,12 @@
 #include "linear/mutex.h"
 #include "linear/timer.h"
 
+#include "atomic.h"
 #include "event_loop_impl.h"
+#include "id_table.h"
+#include "resolver.h"
+#include "thread_context.h"
+#include "timing_wheel.h"
 
 namespace linear {
 
@@ -13,24 +18,34 @@ class HandlerDelegate;
 
 class SocketImpl {
  public:
+  //! gathered messages are flushed without waiting for the corking window over this size
+  static const size_t COALESCING_FLUSH_SIZE = 64 * 1024;
+
+  // RequestTimer is registered by msgid while waiting for response,
+  // and its deadline is tracked by TimingWheel of the event loop
   class RequestTimer {
    public:
     RequestTimer(const linear::Request& r, const linear::weak_ptr<linear::SocketImpl> s,
                  const linear::shared_ptr<linear::EventLoopImpl> l)
-      : request(r), socket(s), timer(l) {}
+      : request(r), socket(s), loop(l) {}
     ~RequestTimer() {
       Stop();
     }
+    // timeout <= 0 means waiting for response forever
     void Start() {
-      timer.Start(linear::EventLoopImpl::OnRequestTimeout, static_cast<uint64_t>(request.timeout_), this);
+      if (request.timeout_ > 0) {
+        loop->GetTimingWheel()->Schedule(&entry, linear::EventLoopImpl::OnRequestTimeout,
+                                         static_cast<unsigned int>(request.timeout_), this);
+      }
     }
     void Stop() {
-      timer.Stop();
+      loop->GetTimingWheel()->Cancel(&entry);
     }
    public:
     linear::Request request;
     linear::weak_ptr<linear::SocketImpl> socket;
-    linear::Timer timer;
+    linear::shared_ptr<linear::EventLoopImpl> loop;
+    linear::TimingWheel::Entry entry;
   };
   
  public:
@@ -48,16 +63,21 @@ class SocketImpl {
 
   inline int GetId() { return id_; }
   inline linear::Socket::Type GetType() { return type_; }
-  inline linear::Socket::State GetState() { return state_; }
+  inline linear::Socket::State GetState() { return state_.Load(); }
   inline const linear::Addrinfo& GetSelfInfo() { return self_; }
   inline const linear::Addrinfo& GetPeerInfo() { return peer_; }
+  // true if called on the thread that runs the event loop of this socket
+  inline bool IsLoopThread() { return (linear::ThreadContext::Get()->GetLoop() == loop_->GetHandle()); }
 
   void SetMaxBufferSize(size_t limit);
   void SetMaxSendBufferSize(size_t limit);
   void SetMaxRecvBufferSize(size_t limit);
+  void SetWriteCoalescing(bool enable, unsigned int cork_usec);
   linear::Error Connect(unsigned int timeout, linear::EventLoopImpl::SocketEvent* ev);
   linear::Error Disconnect(bool handshaking = false);
-  linear::Error Send(const linear::Message& message, int timeout);
+  linear::Error Send(const linear::Message& message, int timeout,
+                     const linear::PackedMessageImpl* packed = NULL);
+  linear::Error Send(const linear::shared_ptr<linear::PackedMessageImpl>& packed, int timeout);
   linear::Error KeepAlive(unsigned int interval, unsigned int retry, Socket::KeepAliveType type);
   linear::Error BindToDevice(const std::string& ifname);
   linear::Error SetSockOpt(int level, int optname, const void* optval, size_t optlen);
@@ -67,23 +87,38 @@ class SocketImpl {
   void OnHandshakeComplete(const shared_ptr<SocketImpl>& socket, tv_stream_t*, int status);
   void OnDisconnect(const shared_ptr<SocketImpl>& socket);
   void OnRead(const shared_ptr<SocketImpl>& socket, const tv_buf_t *buffer, ssize_t nread);
-  void OnWrite(const shared_ptr<SocketImpl>& socket, const linear::Message* message, int status);
+  void OnWrite(const shared_ptr<SocketImpl>& socket, const linear::WriteBuffer* buffer, int status);
   void OnConnectTimeout(const shared_ptr<SocketImpl>& socket);
-  void OnRequestTimeout(const shared_ptr<SocketImpl>& socket, const linear::Request& request);
+  void OnFlushTimeout(const shared_ptr<SocketImpl>& socket);
+  void OnRequestTimeout(const shared_ptr<SocketImpl>& socket, linear::SocketImpl::RequestTimer* request_timer);
 
  protected:
   virtual linear::Error Connect() = 0;
 
-  linear::Socket::State state_;
+  // state_ is read without state_mutex_ (e.g. at every OnRead), and
+  // changed under state_mutex_ unless the change is a single CAS transition.
+  // state_mutex_ keeps stream_ from being closed while in use, and guards write buffers and pending messages
+  linear::Atomic<linear::Socket::State> state_;
   tv_stream_t* stream_;
   linear::EventLoopImpl::SocketEvent* ev_;
   linear::Addrinfo self_, peer_;
+  std::string host_; // host name or address given at creation, peer_ is the address connected to
   std::string bind_ifname_;
   linear::mutex state_mutex_;
   linear::shared_ptr<linear::EventLoopImpl> loop_;
 
  private:
-  linear::Error _Send(linear::Message* ctx);
+  friend class SocketPool;
+
+  linear::Error _Send(linear::Message* ctx, const linear::PackedMessageImpl* packed = NULL);
+  linear::Error _Send(const linear::shared_ptr<linear::PackedMessageImpl>& packed);
+  void _OnWriteError(const shared_ptr<SocketImpl>& socket, const linear::Message& message, int status);
+  void _CancelRequestTimer(uint32_t msgid);
+  linear::WriteBuffer* _Flush(int* status);
+  void _DiscardWriteBuffer(const shared_ptr<SocketImpl>& socket, linear::WriteBuffer* buffer, int status);
+  void _DispatchMessage(const shared_ptr<SocketImpl>& socket,
+                        const shared_ptr<HandlerDelegate>& delegate,
+                        msgpack::object_handle& handle);
   void _SendPendingMessages(const shared_ptr<SocketImpl>& socket);
   void _DiscardMessages(const shared_ptr<SocketImpl>& socket);
 
@@ -96,11 +131,17 @@ class SocketImpl {
   int connect_timeout_;
   linear::Timer connect_timer_;
   std::vector<linear::Message*> pending_messages_;
-  std::vector<linear::SocketImpl::RequestTimer*> request_timers_;
+  linear::IdTable<linear::SocketImpl::RequestTimer> request_timers_;
   linear::mutex request_timer_mutex_;
   size_t max_send_buffer_size_;
   size_t max_recv_buffer_size_;
+  bool write_coalescing_;
+  unsigned int cork_usec_;
+  linear::WriteBuffer* batch_;
+  linear::Timer flush_timer_;
   msgpack::unpacker unpacker_;
+  // reference that keeps this socket alive while it is in a SocketPool, guarded by the lock of its shard
+  linear::shared_ptr<linear::SocketImpl> pool_ref_;
 };
 
 }  // namespace linear
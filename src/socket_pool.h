@@ -5,25 +5,49 @@
 #include "linear/mutex.h"
 #include "linear/group.h"
 
+#include "atomic.h"
+#include "id_table.h"
 #include "socket_impl.h"
 
 namespace linear {
 
+// SocketPool keeps sockets retained by a server or a client until they are disconnected.
+// Sockets are sharded by id, and each shard is an IdTable under its own lock,
+// so Add and Remove are O(1) on average and rarely contend with each other.
+// The number of sockets is counted atomically to check the max limit without locks.
+// Shards map ids to raw pointers, and each socket is retained by its own pool_ref_,
+// so adding a socket allocates nothing but (rarely) a larger table of its shard.
 class SocketPool {
  public:
-  SocketPool() : max_(-1) {
+  static const size_t NUM_OF_SHARDS = 16;
+
+  SocketPool() : max_(-1), size_(0) {
+  }
+  ~SocketPool() {
+    for (size_t i = 0; i < NUM_OF_SHARDS; i++) {
+      std::vector<linear::SocketImpl*> sockets;
+      shards_[i].sockets.Release(&sockets);
+      for (size_t j = 0; j < sockets.size(); j++) {
+        sockets[j]->pool_ref_.reset();
+      }
+    }
   }
-  ~SocketPool() {}
   void SetMaxLimit(size_t max) {
     max_ = max;
   }
+  // checked without locks before a socket is built, Add checks it again
+  bool IsFull() const {
+    return (max_ > 0 && max_ <= size_.Load());
+  }
   linear::Error Add(const linear::shared_ptr<linear::SocketImpl>& s) {
     int id = s->GetId();
     if (id < 0) {
       return Error(LNR_EINVAL);
     }
-    linear::lock_guard<linear::mutex> lock(mutex_);
-    if (max_ > 0 && max_ <= pool_.size()) {
+    // reserve a room first, and give it back on failure
+    size_t size = size_.Add(1);
+    if (max_ > 0 && max_ < size) {
+      size_.Add(-1);
 #ifdef _WIN32
       LINEAR_LOG(linear::log::LOG_WARN, "Socket(type = %d, id = %d) excess MaxLimits(%Iu)",
                  s->GetType(), id, max_);
@@ -33,14 +57,20 @@ class SocketPool {
 #endif
       return Error(LNR_ENOSPC);
     }
-    for (std::vector<linear::shared_ptr<linear::SocketImpl> >::iterator it = pool_.begin();
-         it != pool_.end(); it++) {
-      if (id == (*it)->GetId()) {
-        LINEAR_LOG(linear::log::LOG_WARN, "Socket(type = %d, id = %d) already exists", s->GetType(), id);
-        return Error(LNR_OK);
-      }
+    Shard& shard = GetShard(id);
+    linear::lock_guard<linear::mutex> lock(shard.mutex);
+    if (shard.sockets.Find(id) != NULL) {
+      size_.Add(-1);
+      LINEAR_LOG(linear::log::LOG_WARN, "Socket(type = %d, id = %d) already exists", s->GetType(), id);
+      return Error(LNR_OK);
     }
-    pool_.push_back(s);
+    try {
+      shard.sockets.Insert(id, s.get());
+    } catch(...) {
+      size_.Add(-1);
+      return Error(LNR_ENOMEM);
+    }
+    s->pool_ref_ = s;
     LINEAR_DEBUG(linear::log::LOG_DEBUG, "Socket(type = %d, id = %d) is added", s->GetType(), id);
     return Error(LNR_OK);
   }
@@ -49,30 +79,53 @@ class SocketPool {
     if (id < 0) {
       return;
     }
-    linear::lock_guard<linear::mutex> lock(mutex_);
-    for (std::vector<linear::shared_ptr<linear::SocketImpl> >::iterator it = pool_.begin();
-         it != pool_.end(); it++) {
-      if (id == (*it)->GetId()) {
-        LINEAR_DEBUG(linear::log::LOG_DEBUG, "Socket(type = %d, id = %d) is removed", s->GetType(), id);
-        pool_.erase(it);
-        return;
-      }
+    Shard& shard = GetShard(id);
+    linear::unique_lock<linear::mutex> lock(shard.mutex);
+    linear::SocketImpl* removed = shard.sockets.Remove(id);
+    // the socket may be destroyed when released, so release it out of the lock
+    linear::shared_ptr<linear::SocketImpl> retained;
+    if (removed != NULL) {
+      retained.swap(removed->pool_ref_);
     }
-    LINEAR_LOG(linear::log::LOG_WARN, "Socket(id = %d) is already removed", id);
+    lock.unlock();
+    if (!retained) {
+      LINEAR_LOG(linear::log::LOG_WARN, "Socket(id = %d) is already removed", id);
+      return;
+    }
+    size_.Add(-1);
+    LINEAR_DEBUG(linear::log::LOG_DEBUG, "Socket(type = %d, id = %d) is removed", s->GetType(), id);
   }
   void Clear() {
-    linear::lock_guard<linear::mutex> lock(mutex_);
-    for (std::vector<linear::shared_ptr<linear::SocketImpl> >::iterator it = pool_.begin();
-         it != pool_.end(); it++) {
-      linear::Group::LeaveAll(Socket(*it));
+    for (size_t i = 0; i < NUM_OF_SHARDS; i++) {
+      std::vector<linear::SocketImpl*> sockets;
+      std::vector<linear::shared_ptr<linear::SocketImpl> > retained;
+      linear::unique_lock<linear::mutex> lock(shards_[i].mutex);
+      retained.resize(shards_[i].sockets.size());
+      shards_[i].sockets.Release(&sockets);
+      for (size_t j = 0; j < sockets.size(); j++) {
+        retained[j].swap(sockets[j]->pool_ref_);
+      }
+      lock.unlock();
+      size_.Add(-static_cast<long>(retained.size()));
+      for (size_t j = 0; j < retained.size(); j++) {
+        linear::Group::LeaveAll(Socket(retained[j]));
+      }
     }
-    pool_.clear();
   }
 
  protected:
+  struct Shard {
+    linear::IdTable<linear::SocketImpl> sockets;
+    linear::mutex mutex;
+  };
+
+  Shard& GetShard(int id) {
+    return shards_[static_cast<unsigned int>(id) % NUM_OF_SHARDS];
+  }
+
   size_t max_;
-  std::vector<shared_ptr<linear::SocketImpl> > pool_;
-  linear::mutex mutex_;
+  linear::Atomic<size_t> size_;
+  Shard shards_[NUM_OF_SHARDS];
 };
 
 } // namespace linear
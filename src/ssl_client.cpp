@@ -19,6 +19,14 @@ SSLClient::SSLClient(const shared_ptr<Handler>& handler,
   client_ = shared_ptr<SSLClientImpl>(new SSLClientImpl(handler, SSLContext(), loop));
 }
 
+SSLClient::SSLClient(const shared_ptr<Handler>& handler,
+                     const SSLContext& context,
+                     const EventLoopPool& pool) {
+  shared_ptr<SSLClientImpl> client = shared_ptr<SSLClientImpl>(new SSLClientImpl(handler, context, pool.GetEventLoop(0)));
+  client->SetEventLoopPool(pool.GetImpl());
+  client_ = client;
+}
+
 void SSLClient::SetSSLContext(const SSLContext& context) {
   if (client_) {
     static_pointer_cast<SSLClientImpl>(client_)->SetSSLContext(context);
@@ -26,7 +26,7 @@ class SSLClientImpl : public ClientImpl {
   linear::SSLSocket CreateSocket(const std::string& hostname, int port,
                                  const linear::SSLContext& context,
                                  const linear::weak_ptr<linear::HandlerDelegate>& delegate) {
-    return SSLSocket(shared_ptr<SSLSocketImpl>(new SSLSocketImpl(hostname, port, context, loop_, delegate)));
+    return SSLSocket(shared_ptr<SSLSocketImpl>(new SSLSocketImpl(hostname, port, context, NextLoop(), delegate)));
   }
  private:
   linear::SSLContext context_;
@@ -13,7 +13,7 @@ class SSLServerImpl : public ServerImpl {
                 const linear::SSLContext& context,
                 const linear::EventLoop& loop);
   virtual ~SSLServerImpl();
-  linear::Error Start(const std::string& hostname, int port,
+  linear::Error Start(const std::string& hostname, int port, int backlog,
                       linear::EventLoopImpl::ServerEvent* ev);
   linear::Error Stop();
   void OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, int status);
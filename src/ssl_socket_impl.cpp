@@ -54,7 +54,7 @@ Error SSLSocketImpl::Connect() {
 
 Error SSLSocketImpl::GetVerifyResult() {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTED && state_ != Socket::CONNECTING) {
+  if (state_.Load() != Socket::CONNECTED && state_.Load() != Socket::CONNECTING) {
     return Error(LNR_ENOTCONN);
   }
   int ret = tv_ssl_get_verify_result(reinterpret_cast<tv_ssl_t*>(stream_));
@@ -67,7 +67,7 @@ Error SSLSocketImpl::GetVerifyResult() {
 
 bool SSLSocketImpl::PresentPeerCertificate() {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTED && state_ != Socket::CONNECTING) {
+  if (state_.Load() != Socket::CONNECTED && state_.Load() != Socket::CONNECTING) {
     return false;
   }
   X509* xcert = tv_ssl_get_peer_certificate(reinterpret_cast<tv_ssl_t*>(stream_));
@@ -80,7 +80,7 @@ bool SSLSocketImpl::PresentPeerCertificate() {
 
 X509Certificate SSLSocketImpl::GetPeerCertificate() {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTED && state_ != Socket::CONNECTING) {
+  if (state_.Load() != Socket::CONNECTED && state_.Load() != Socket::CONNECTING) {
     throw std::runtime_error("peer certificate does not exist");
   }
   // SSL_get_peer_certificate returns a new X509* object
@@ -95,7 +95,7 @@ X509Certificate SSLSocketImpl::GetPeerCertificate() {
 
 std::vector<X509Certificate> SSLSocketImpl::GetPeerCertificateChain() {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTED && state_ != Socket::CONNECTING) {
+  if (state_.Load() != Socket::CONNECTED && state_.Load() != Socket::CONNECTING) {
     throw std::runtime_error("peer certificate does not exist");
   }
   // SSL_get_peer_cert_chain returns a X509* array and frees them when onclose
@@ -0,0 +1,180 @@
+#ifndef LINEAR_STATELESS_NONCE_H_
+#define LINEAR_STATELESS_NONCE_H_
+
+#include <stdint.h>
+
+#include <set>
+#include <string>
+
+#include "tv.h"
+#include "linear/log.h"
+#include "linear/mutex.h"
+
+#include "atomic.h"
+#include "nonce_pool.h"
+
+#define NONCE_KEY_SIZE (64)   // block size of MD5
+#define NONCE_STAMP_SIZE (8)  // msecs(48bit) << 16 | sequence(16bit)
+#define NONCE_MAC_SIZE (16)
+
+namespace linear {
+
+// StatelessNonce issues Digest nonces that need no state until they are used, instead of NoncePool.
+// nonce: b64enc(stamp(8byte) + HMAC-MD5(secret, stamp)(16byte)) => 32byte, same length as NoncePool
+// - the secret is random per instance, so a nonce is valid only for the server that issued it
+// - a nonce is valid for timeout msecs after it is issued, and the MAC is compared in constant time
+// - used stamps are kept as a replay filter in 2 generations of timeout msecs,
+//   so the filter holds only nonces used within the last 2 * timeout msecs, and no timer is needed
+class StatelessNonce {
+ public:
+  explicit StatelessNonce(int timeout = NONCE_TIMEOUT)
+    : timeout_((timeout > 0) ? timeout : NONCE_TIMEOUT), sequence_(0), generation_(0), initialized_(false) {
+    buffer b;
+    buffer_init(&b);
+    if (buffer_fill_random(&b, NONCE_KEY_SIZE) < 0 || b.len != NONCE_KEY_SIZE) {
+      LINEAR_LOG(linear::log::LOG_ERR, "fail to create secret of nonce");
+      buffer_fin(&b);
+      return;
+    }
+    for (size_t i = 0; i < NONCE_KEY_SIZE; i++) {
+      ipad_[i] = static_cast<unsigned char>(b.ptr[i]) ^ 0x36;
+      opad_[i] = static_cast<unsigned char>(b.ptr[i]) ^ 0x5c;
+    }
+    buffer_fin(&b);
+    initialized_ = true;
+  }
+  ~StatelessNonce() {}
+
+  linear::Error Issue(std::string* nonce) {
+    if (!initialized_ || nonce == NULL) {
+      return linear::Error(LNR_EINVAL);
+    }
+    uint64_t stamp = (Now() << 16) | (static_cast<uint64_t>(sequence_.Add(1)) & 0xffff);
+    unsigned char raw[NONCE_STAMP_SIZE + NONCE_MAC_SIZE];
+    for (size_t i = 0; i < NONCE_STAMP_SIZE; i++) {
+      raw[i] = static_cast<unsigned char>(stamp >> (8 * (NONCE_STAMP_SIZE - 1 - i)));
+    }
+    if (!Sign(raw, raw + NONCE_STAMP_SIZE)) {
+      return linear::Error(LNR_ENOMEM);
+    }
+    buffer b;
+    buffer_init(&b);
+    if (buffer_append(&b, reinterpret_cast<const char*>(raw), sizeof(raw)) < 0 || buffer_to_base64(&b) < 0) {
+      buffer_fin(&b);
+      return linear::Error(LNR_ENOMEM);
+    }
+    nonce->assign(b.ptr, b.len);
+    buffer_fin(&b);
+    return linear::Error(LNR_OK);
+  }
+
+  // return true only at the first use of a valid nonce
+  bool Consume(const std::string& nonce) {
+    unsigned char raw[NONCE_STAMP_SIZE + NONCE_MAC_SIZE];
+    if (!initialized_ || !Decode(nonce, raw)) {
+      LINEAR_DEBUG(linear::log::LOG_WARN, "Nonce(%s) is malformed", nonce.c_str());
+      return false;
+    }
+    unsigned char mac[NONCE_MAC_SIZE];
+    if (!Sign(raw, mac)) {
+      return false;
+    }
+    unsigned char diff = 0;
+    for (size_t i = 0; i < NONCE_MAC_SIZE; i++) {
+      diff |= mac[i] ^ raw[NONCE_STAMP_SIZE + i];
+    }
+    if (diff != 0) {
+      LINEAR_DEBUG(linear::log::LOG_WARN, "Nonce(%s) is invalid", nonce.c_str());
+      return false;
+    }
+    uint64_t stamp = 0;
+    for (size_t i = 0; i < NONCE_STAMP_SIZE; i++) {
+      stamp = (stamp << 8) | raw[i];
+    }
+    uint64_t issued = stamp >> 16;
+    uint64_t now = Now();
+    if (issued > now || now - issued >= static_cast<uint64_t>(timeout_)) {
+      LINEAR_DEBUG(linear::log::LOG_WARN, "Nonce(%s) is expired", nonce.c_str());
+      return false;
+    }
+    linear::lock_guard<linear::mutex> lock(mutex_);
+    uint64_t current = now / timeout_;
+    if (current > generation_) {
+      used_[current % 2].clear();
+      if (current > generation_ + 1) {
+        used_[(current + 1) % 2].clear();
+      }
+      generation_ = current;
+    }
+    if (!used_[(issued / timeout_) % 2].insert(stamp).second) {
+      LINEAR_DEBUG(linear::log::LOG_WARN, "Nonce(%s) is already used", nonce.c_str());
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  StatelessNonce(const StatelessNonce&);
+  StatelessNonce& operator=(const StatelessNonce&);
+
+  static uint64_t Now() {
+    return uv_hrtime() / 1000000;
+  }
+  static bool Decode(const std::string& nonce, unsigned char* raw) {
+    buffer b;
+    buffer_init(&b);
+    if (buffer_append(&b, nonce.c_str(), nonce.size()) < 0 || buffer_from_base64(&b) < 0 ||
+        b.len != NONCE_STAMP_SIZE + NONCE_MAC_SIZE) {
+      buffer_fin(&b);
+      return false;
+    }
+    for (size_t i = 0; i < NONCE_STAMP_SIZE + NONCE_MAC_SIZE; i++) {
+      raw[i] = static_cast<unsigned char>(b.ptr[i]);
+    }
+    buffer_fin(&b);
+    return true;
+  }
+  // md = MD5(pad + data), buffer_to_md5sum makes a hex string
+  static bool Digest(const unsigned char* pad, const unsigned char* data, size_t len, unsigned char* md) {
+    buffer b;
+    buffer_init(&b);
+    if (buffer_append(&b, reinterpret_cast<const char*>(pad), NONCE_KEY_SIZE) < 0 ||
+        buffer_append(&b, reinterpret_cast<const char*>(data), len) < 0 ||
+        buffer_to_md5sum(&b) < 0 || b.len != NONCE_MAC_SIZE * 2) {
+      buffer_fin(&b);
+      return false;
+    }
+    for (size_t i = 0; i < NONCE_MAC_SIZE; i++) {
+      md[i] = static_cast<unsigned char>((Hex(b.ptr[2 * i]) << 4) | Hex(b.ptr[2 * i + 1]));
+    }
+    buffer_fin(&b);
+    return true;
+  }
+  static unsigned char Hex(char c) {
+    if (c >= '0' && c <= '9') {
+      return static_cast<unsigned char>(c - '0');
+    } else if (c >= 'a' && c <= 'f') {
+      return static_cast<unsigned char>(c - 'a' + 10);
+    }
+    return static_cast<unsigned char>(c - 'A' + 10);
+  }
+  // HMAC-MD5(secret, stamp)
+  bool Sign(const unsigned char* stamp, unsigned char* mac) const {
+    unsigned char inner[NONCE_MAC_SIZE];
+    return (Digest(ipad_, stamp, NONCE_STAMP_SIZE, inner) &&
+            Digest(opad_, inner, NONCE_MAC_SIZE, mac));
+  }
+
+  int timeout_;
+  unsigned char ipad_[NONCE_KEY_SIZE];
+  unsigned char opad_[NONCE_KEY_SIZE];
+  linear::Atomic<long> sequence_;
+  uint64_t generation_;
+  std::set<uint64_t> used_[2];
+  bool initialized_;
+  linear::mutex mutex_;
+};
+
+} // namespace linear
+
+#endif // LINEAR_STATELESS_NONCE_H_
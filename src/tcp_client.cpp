@@ -11,6 +11,12 @@ TCPClient::TCPClient(const shared_ptr<Handler>& handler, const EventLoop& loop)
   client_ = shared_ptr<TCPClientImpl>(new TCPClientImpl(handler, loop));
 }
 
+TCPClient::TCPClient(const shared_ptr<Handler>& handler, const EventLoopPool& pool) {
+  shared_ptr<TCPClientImpl> client = shared_ptr<TCPClientImpl>(new TCPClientImpl(handler, pool.GetEventLoop(0)));
+  client->SetEventLoopPool(pool.GetImpl());
+  client_ = client;
+}
+
 TCPSocket TCPClient::CreateSocket(const std::string& hostname, int port) {
   if (client_) {
     return static_pointer_cast<TCPClientImpl>(client_)->CreateSocket(hostname, port, client_);
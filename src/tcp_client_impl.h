@@ -16,7 +16,7 @@ class TCPClientImpl : public ClientImpl {
   ~TCPClientImpl() {}
   linear::TCPSocket CreateSocket(const std::string& hostname, int port,
                                  const linear::weak_ptr<linear::HandlerDelegate>& delegate) {
-    return TCPSocket(shared_ptr<TCPSocketImpl>(new TCPSocketImpl(hostname, port, loop_, delegate)));
+    return TCPSocket(shared_ptr<TCPSocketImpl>(new TCPSocketImpl(hostname, port, NextLoop(), delegate)));
   }
 };
 
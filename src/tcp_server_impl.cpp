@@ -20,7 +20,7 @@ TCPServerImpl::~TCPServerImpl() {
   Stop();
 }
 
-Error TCPServerImpl::Start(const std::string& hostname, int port, EventLoopImpl::ServerEvent* ev) {
+Error TCPServerImpl::Start(const std::string& hostname, int port, int backlog, EventLoopImpl::ServerEvent* ev) {
   lock_guard<mutex> lock(mutex_);
   if (state_ == START) {
     return Error(LNR_EALREADY);
@@ -55,7 +55,7 @@ Error TCPServerImpl::Start(const std::string& hostname, int port, EventLoopImpl:
   std::ostringstream port_str;
   port_str << port;
   ret = tv_listen(reinterpret_cast<tv_stream_t*>(handle_),
-                  hostname.c_str(), port_str.str().c_str(), ServerImpl::BACKLOG, EventLoopImpl::OnAccept);
+                  hostname.c_str(), port_str.str().c_str(), backlog, EventLoopImpl::OnAccept);
   if (ret) {
     Error err(ret);
     LINEAR_LOG(LOG_ERR, "fail to start server(%s:%d,TCP): %s",
@@ -105,6 +105,16 @@ void TCPServerImpl::OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, i
                self_.port);
     return;
   }
+  // reject before building a socket
+  Error err = Admit();
+  if (err != Error(LNR_OK)) {
+    LINEAR_LOG(LOG_WARN, "reject connection at %s:%d,TCP, reason = %s",
+               (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
+               self_.port,
+               err.Message().c_str());
+    tv_close(reinterpret_cast<tv_handle_t*>(cli_stream), EventLoopImpl::OnReject);
+    return;
+  }
   try {
     weak_ptr<HandlerDelegate> self = reinterpret_cast<EventLoopImpl::ServerEvent*>(handle_->data)->server;
     shared_ptr<TCPSocketImpl> shared = shared_ptr<TCPSocketImpl>(new TCPSocketImpl(cli_stream, loop_, self));
@@ -10,7 +10,7 @@ class TCPServerImpl : public ServerImpl {
   TCPServerImpl(const linear::weak_ptr<linear::Handler>& handler,
                 const linear::EventLoop& loop);
   virtual ~TCPServerImpl();
-  linear::Error Start(const std::string& hostname, int port,
+  linear::Error Start(const std::string& hostname, int port, int backlog,
                       linear::EventLoopImpl::ServerEvent* ev);
   linear::Error Stop();
   void OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, int status);
@@ -0,0 +1,72 @@
+#ifndef LINEAR_THREAD_CONTEXT_H_
+#define LINEAR_THREAD_CONTEXT_H_
+
+#include <cassert>
+
+#include "tv.h"
+
+namespace linear {
+
+// ThreadContext holds per-thread state of linear.
+// - loop: the event loop that the thread runs, or NULL if the thread is not an event loop thread
+// - event: a semaphore to park the thread on, reused across blocking calls of the thread
+// It is created at the first use in each thread, and is not freed when the thread exits
+// (uv_key_t has no destructor), so only threads that use it leak one small object.
+class ThreadContext {
+ public:
+  static ThreadContext* Get() {
+    uv_once(&once_, CreateKey);
+    ThreadContext* context = static_cast<ThreadContext*>(uv_key_get(&key_));
+    if (context == NULL) {
+      context = new ThreadContext();
+      uv_key_set(&key_, context);
+    }
+    return context;
+  }
+
+  // called at the entry of every callback from event loops, and set only once per thread
+  void SetLoop(tv_loop_t* loop) {
+    if (loop_ == NULL) {
+      loop_ = loop;
+    }
+  }
+  tv_loop_t* GetLoop() const {
+    return loop_;
+  }
+
+  // each Wait must be paired with exactly one Post
+  void Wait() {
+    uv_sem_wait(&event_);
+  }
+  void Post() {
+    uv_sem_post(&event_);
+  }
+
+ private:
+  ThreadContext() : loop_(NULL) {
+    if (uv_sem_init(&event_, 0)) {
+      assert(false);
+    }
+  }
+  ~ThreadContext() {
+    uv_sem_destroy(&event_);
+  }
+  ThreadContext(const ThreadContext&);
+  ThreadContext& operator=(const ThreadContext&);
+
+  static void CreateKey() {
+    if (uv_key_create(&key_)) {
+      assert(false);
+    }
+  }
+
+  static uv_once_t once_;
+  static uv_key_t key_;
+
+  tv_loop_t* loop_;
+  uv_sem_t event_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_THREAD_CONTEXT_H_
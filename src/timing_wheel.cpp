@@ -0,0 +1,250 @@
+#include <cstdlib>
+
+#include "linear/log.h"
+
+#include "thread_context.h"
+#include "timing_wheel.h"
+
+using namespace linear::log;
+
+namespace linear {
+
+TimingWheel::TimingWheel(tv_loop_t* loop)
+  : loop_(loop), tv_timer_(NULL), ev_(NULL), armed_(false), armed_at_(0),
+    current_(Now()), size_(0), fired_(NULL), firing_(NULL) {
+  for (unsigned int level = 0; level < LEVELS; level++) {
+    for (unsigned int slot = 0; slot < SLOTS; slot++) {
+      slots_[level][slot] = NULL;
+    }
+  }
+}
+
+TimingWheel::~TimingWheel() {
+  lock_guard<mutex> lock(mutex_);
+  for (unsigned int level = 0; level < LEVELS; level++) {
+    for (unsigned int slot = 0; slot < SLOTS; slot++) {
+      while (slots_[level][slot] != NULL) {
+        Unlink(slots_[level][slot]);
+      }
+    }
+  }
+  while (fired_ != NULL) {
+    fired_->fired_ = false;
+    Unlink(fired_);
+  }
+  if (tv_timer_ != NULL) {
+    // ev_ is deleted at EventLoopImpl::OnClose
+    tv_timer_stop(tv_timer_);
+    tv_close(reinterpret_cast<tv_handle_t*>(tv_timer_), EventLoopImpl::OnClose);
+  } else {
+    delete ev_;
+  }
+}
+
+void TimingWheel::SetEvent(EventLoopImpl::TimingWheelEvent* ev) {
+  lock_guard<mutex> lock(mutex_);
+  assert(ev_ == NULL && tv_timer_ == NULL);
+  ev_ = ev;
+}
+
+Error TimingWheel::Schedule(TimingWheel::Entry* entry, TimerCallback callback,
+                            unsigned int timeout, void* args) {
+  assert(entry != NULL && callback != NULL);
+  lock_guard<mutex> lock(mutex_);
+  if (entry->pprev_ != NULL) {
+    return Error(LNR_EALREADY);
+  }
+  uint64_t now = Now();
+  if (size_ == 0 && current_ < now) {
+    // nothing to be fired between current_ and now
+    current_ = now;
+  }
+  uint64_t expire = now + (timeout + TICK - 1) / TICK;
+  if (expire <= current_) {
+    expire = current_ + 1;
+  }
+  entry->expire_ = expire;
+  entry->callback_ = callback;
+  entry->args_ = args;
+  Link(entry);
+  size_++;
+  int ret = Arm(now);
+  if (ret) {
+    Unlink(entry);
+    size_--;
+    Error err(ret);
+    LINEAR_LOG(LOG_ERR, "fail to schedule timer: %s", err.Message().c_str());
+    return err;
+  }
+  return Error(LNR_OK);
+}
+
+void TimingWheel::Cancel(TimingWheel::Entry* entry) {
+  assert(entry != NULL);
+  unique_lock<mutex> lock(mutex_);
+  if (entry->pprev_ != NULL) {
+    if (entry->fired_) {
+      // fired but not called yet
+      entry->fired_ = false;
+      Unlink(entry);
+    } else {
+      Unlink(entry);
+      size_--;
+      // tv_timer is stopped at next tick if no more entries
+    }
+    return;
+  }
+  if (firing_ == entry && ThreadContext::Get()->GetLoop() != loop_) {
+    while (firing_ == entry) {
+      fire_done_.wait(lock);
+    }
+  }
+}
+
+void TimingWheel::OnTick() {
+  unique_lock<mutex> lock(mutex_);
+  armed_ = false;
+  uint64_t now = Now();
+  while (current_ < now) {
+    if (size_ == 0) {
+      current_ = now;
+      break;
+    }
+    current_++;
+    for (unsigned int level = LEVELS - 1; level > 0; level--) {
+      if ((current_ & ((static_cast<uint64_t>(1) << (SLOT_BITS * level)) - 1)) == 0) {
+        Cascade(level);
+      }
+    }
+    TimingWheel::Entry* entry = slots_[0][current_ & (SLOTS - 1)];
+    while (entry != NULL) {
+      TimingWheel::Entry* next = entry->next_;
+      if (entry->expire_ <= current_) {
+        Unlink(entry);
+        size_--;
+        entry->fired_ = true;
+        entry->next_ = fired_;
+        if (fired_ != NULL) {
+          fired_->pprev_ = &entry->next_;
+        }
+        fired_ = entry;
+        entry->pprev_ = &fired_;
+      }
+      entry = next;
+    }
+  }
+  Arm(now);
+
+  // entries fired may be cancelled or deleted while the lock is released for callbacks,
+  // so take them one by one
+  while (fired_ != NULL) {
+    TimingWheel::Entry* entry = fired_;
+    entry->fired_ = false;
+    Unlink(entry);
+    TimerCallback callback = entry->callback_;
+    void* args = entry->args_;
+    firing_ = entry;
+    lock.unlock();
+    callback(args);
+    lock.lock();
+    firing_ = NULL;
+    fire_done_.notify_all();
+  }
+}
+
+uint64_t TimingWheel::Now() {
+  return uv_hrtime() / (static_cast<uint64_t>(1000000) * TICK);
+}
+
+void TimingWheel::Link(TimingWheel::Entry* entry) {
+  uint64_t expire = (entry->expire_ > current_) ? entry->expire_ : current_;
+  uint64_t delta = expire - current_;
+  unsigned int level = 0;
+  while (level < LEVELS - 1 && delta >= (static_cast<uint64_t>(1) << (SLOT_BITS * (level + 1)))) {
+    level++;
+  }
+  if (delta >= (static_cast<uint64_t>(1) << (SLOT_BITS * LEVELS))) {
+    // beyond the wheels, and re-linked when cascaded
+    expire = current_ + (static_cast<uint64_t>(1) << (SLOT_BITS * LEVELS)) - 1;
+  }
+  TimingWheel::Entry** head = &slots_[level][(expire >> (SLOT_BITS * level)) & (SLOTS - 1)];
+  entry->next_ = *head;
+  if (*head != NULL) {
+    (*head)->pprev_ = &entry->next_;
+  }
+  *head = entry;
+  entry->pprev_ = head;
+}
+
+void TimingWheel::Unlink(TimingWheel::Entry* entry) {
+  *(entry->pprev_) = entry->next_;
+  if (entry->next_ != NULL) {
+    entry->next_->pprev_ = entry->pprev_;
+  }
+  entry->next_ = NULL;
+  entry->pprev_ = NULL;
+}
+
+// move entries of the slot that current_ reaches to lower levels
+void TimingWheel::Cascade(unsigned int level) {
+  TimingWheel::Entry** head = &slots_[level][(current_ >> (SLOT_BITS * level)) & (SLOTS - 1)];
+  TimingWheel::Entry* entry = *head;
+  *head = NULL;
+  while (entry != NULL) {
+    TimingWheel::Entry* next = entry->next_;
+    entry->next_ = NULL;
+    entry->pprev_ = NULL;
+    Link(entry);
+    entry = next;
+  }
+}
+
+// the earliest tick that may have something to do
+uint64_t TimingWheel::NextTick() {
+  for (unsigned int i = 1; i <= SLOTS; i++) {
+    uint64_t tick = current_ + i;
+    if (slots_[0][tick & (SLOTS - 1)] != NULL || (tick & (SLOTS - 1)) == 0) {
+      return tick;
+    }
+  }
+  assert(false);
+  return current_ + SLOTS;
+}
+
+int TimingWheel::Arm(uint64_t now) {
+  if (size_ == 0) {
+    if (armed_) {
+      tv_timer_stop(tv_timer_);
+      armed_ = false;
+    }
+    return 0;
+  }
+  uint64_t next = NextTick();
+  if (armed_ && armed_at_ <= next) {
+    return 0;
+  }
+  if (tv_timer_ == NULL) {
+    assert(ev_ != NULL);
+    tv_timer_ = static_cast<tv_timer_t*>(malloc(sizeof(tv_timer_t)));
+    if (tv_timer_ == NULL) {
+      return TV_ENOMEM;
+    }
+    int ret = tv_timer_init(loop_, tv_timer_);
+    if (ret) {
+      free(tv_timer_);
+      tv_timer_ = NULL;
+      return ret;
+    }
+    tv_timer_->data = ev_;
+  }
+  uint64_t timeout = (next > now) ? (next - now) * TICK : 0;
+  int ret = tv_timer_start(tv_timer_, EventLoopImpl::OnTick, timeout, 0);
+  if (ret) {
+    return ret;
+  }
+  armed_ = true;
+  armed_at_ = next;
+  return 0;
+}
+
+}  // namespace linear
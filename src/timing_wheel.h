@@ -0,0 +1,95 @@
+/**
+ * @file timing_wheel.h
+ * Timing wheel class definition
+ */
+
+#ifndef LINEAR_TIMING_WHEEL_H_
+#define LINEAR_TIMING_WHEEL_H_
+
+#include <stdint.h>
+
+#include "linear/condition_variable.h"
+#include "linear/mutex.h"
+#include "linear/timer.h"
+
+#include "event_loop_impl.h"
+
+namespace linear {
+
+// TimingWheel tracks many oneshot deadlines of an EventLoop by one tv_timer.
+// Deadlines are kept in hierarchical wheels (LEVELS x SLOTS buckets of TICK msec),
+// so that scheduling and cancelling are O(1) without any allocation,
+// and the tv_timer is woken up at most once per tick, and only while some deadlines are pending.
+// Callbacks are called on the event loop thread without any lock held, one by one.
+// Cancel fences against fires: once it returns, the callback of the entry is neither running nor going to run,
+// so the object that embeds the entry may be deleted right after that.
+// - an entry that is fired at the tick but not called yet is just removed
+// - an entry whose callback is running on the event loop thread is waited for,
+//   unless Cancel is called from the callback itself (on the event loop thread)
+class TimingWheel {
+ public:
+  static const unsigned int TICK = 1; // msec
+  static const unsigned int SLOT_BITS = 6;
+  static const unsigned int SLOTS = (1 << SLOT_BITS);
+  static const unsigned int LEVELS = 4; // covers about 4.6 hours by TICK == 1, longer ones are re-scheduled
+
+  // Entry is embedded in an object that has a deadline, and must outlive its schedule
+  class Entry {
+   public:
+    Entry() : next_(NULL), pprev_(NULL), expire_(0), callback_(NULL), args_(NULL), fired_(false) {}
+    ~Entry() {}
+
+   private:
+    friend class TimingWheel;
+    Entry(const Entry&);
+    Entry& operator=(const Entry&);
+
+    Entry* next_;
+    Entry** pprev_; // NULL while not scheduled
+    uint64_t expire_; // tick
+    linear::TimerCallback callback_;
+    void* args_;
+    bool fired_; // linked to the fired list instead of wheels
+  };
+
+ public:
+  explicit TimingWheel(tv_loop_t* loop);
+  ~TimingWheel();
+
+  // ev is owned by TimingWheel
+  void SetEvent(linear::EventLoopImpl::TimingWheelEvent* ev);
+  linear::Error Schedule(linear::TimingWheel::Entry* entry, linear::TimerCallback callback,
+                         unsigned int timeout, void* args);
+  // do nothing if entry is not scheduled, or its callback has been already called.
+  // wait for the callback if it is running on the event loop thread now
+  void Cancel(linear::TimingWheel::Entry* entry);
+  void OnTick();
+
+ private:
+  TimingWheel(const TimingWheel&);
+  TimingWheel& operator=(const TimingWheel&);
+
+  static uint64_t Now();
+  void Link(linear::TimingWheel::Entry* entry);
+  void Unlink(linear::TimingWheel::Entry* entry);
+  void Cascade(unsigned int level);
+  uint64_t NextTick();
+  int Arm(uint64_t now);
+
+  tv_loop_t* loop_;
+  tv_timer_t* tv_timer_;
+  linear::EventLoopImpl::TimingWheelEvent* ev_;
+  bool armed_;
+  uint64_t armed_at_; // tick
+  uint64_t current_;  // tick processed last
+  size_t size_;
+  linear::TimingWheel::Entry* slots_[LEVELS][SLOTS];
+  linear::TimingWheel::Entry* fired_;  // fired at the tick, and waiting for the callback
+  linear::TimingWheel::Entry* firing_; // callback is running now, only for comparison (may be deleted)
+  linear::condition_variable fire_done_;
+  linear::mutex mutex_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_TIMING_WHEEL_H_
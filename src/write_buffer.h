@@ -0,0 +1,148 @@
+/**
+ * @file write_buffer.h
+ * Write buffer class definition
+ */
+
+#ifndef LINEAR_WRITE_BUFFER_H_
+#define LINEAR_WRITE_BUFFER_H_
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "tv.h"
+
+#include "linear/message.h"
+#include "linear/mutex.h"
+
+#include "packed_message_impl.h"
+
+namespace linear {
+
+class WriteBufferPool;
+
+// WriteBuffer is handed to tv_write as is.
+// It satisfies msgpack's stream interface so that messages are packed into it directly,
+// and embeds tv_write_t so that sending a message needs no allocation once it is recycled.
+// Several messages are packed back to back when write coalescing is enabled.
+// A message packed beforehand is referred by packs, and written from its own data
+// unless it is gathered with other messages.
+class WriteBuffer {
+ public:
+  static const size_t INITIAL_CAPACITY = 8192;
+
+  explicit WriteBuffer(linear::WriteBufferPool* p)
+    : pool(p), data_(NULL), size_(0), capacity_(0) {
+    request.data = this;
+  }
+  ~WriteBuffer() {
+    Reset();
+    free(data_);
+  }
+
+  // msgpack stream interface (throws std::bad_alloc)
+  void write(const char* buf, size_t len) {
+    if (capacity_ - size_ < len) {
+      Expand(len);
+    }
+    memcpy(data_ + size_, buf, len);
+    size_ += len;
+  }
+  inline char* data() { return data_; }
+  inline size_t size() const { return size_; }
+  inline size_t capacity() const { return capacity_; }
+  // drop bytes written after size (used to roll back a message failed to pack)
+  void Truncate(size_t size) {
+    assert(size <= size_);
+    size_ = size;
+  }
+  void Reset() {
+    for (std::vector<linear::Message*>::iterator it = messages.begin(); it != messages.end(); it++) {
+      delete *it;
+    }
+    messages.clear();
+    packs.clear();
+    size_ = 0;
+  }
+
+ public:
+  tv_write_t request;
+  std::vector<linear::Message*> messages;
+  std::vector<linear::shared_ptr<linear::PackedMessageImpl> > packs;
+  linear::WriteBufferPool* pool;
+
+ private:
+  WriteBuffer(const WriteBuffer&);
+  WriteBuffer& operator=(const WriteBuffer&);
+  void Expand(size_t len) {
+    size_t capacity = (capacity_ == 0) ? INITIAL_CAPACITY : capacity_;
+    while (capacity - size_ < len) {
+      capacity *= 2;
+    }
+    char* data = static_cast<char*>(realloc(data_, capacity));
+    if (data == NULL) {
+      throw std::bad_alloc();
+    }
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+  char* data_;
+  size_t size_;
+  size_t capacity_;
+};
+
+// WriteBufferPool keeps released buffers per EventLoop.
+// Buffers grown over MAX_POOLED_CAPACITY are freed instead of pooled, so that
+// one big message does not pin its memory forever.
+class WriteBufferPool {
+ public:
+  static const size_t MAX_POOLED_BUFFERS = 256;
+  static const size_t MAX_POOLED_CAPACITY = 64 * 1024;
+
+  WriteBufferPool() {}
+  ~WriteBufferPool() {
+    for (std::vector<linear::WriteBuffer*>::iterator it = pool_.begin(); it != pool_.end(); it++) {
+      delete *it;
+    }
+  }
+  // throws std::bad_alloc
+  linear::WriteBuffer* Acquire() {
+    linear::unique_lock<linear::mutex> lock(mutex_);
+    if (!pool_.empty()) {
+      linear::WriteBuffer* buffer = pool_.back();
+      pool_.pop_back();
+      return buffer;
+    }
+    lock.unlock();
+    return new WriteBuffer(this);
+  }
+  void Release(linear::WriteBuffer* buffer) {
+    assert(buffer != NULL && buffer->pool == this);
+    buffer->Reset();
+    if (buffer->capacity() <= MAX_POOLED_CAPACITY) {
+      linear::lock_guard<linear::mutex> lock(mutex_);
+      if (pool_.size() < MAX_POOLED_BUFFERS) {
+        try {
+          pool_.push_back(buffer);
+          return;
+        } catch(...) {
+        }
+      }
+    }
+    delete buffer;
+  }
+
+ private:
+  WriteBufferPool(const WriteBufferPool&);
+  WriteBufferPool& operator=(const WriteBufferPool&);
+
+  std::vector<linear::WriteBuffer*> pool_;
+  linear::mutex mutex_;
+};
+
+}  // namespace linear
+
+#endif  // LINEAR_WRITE_BUFFER_H_
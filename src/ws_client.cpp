@@ -19,6 +19,14 @@ WSClient::WSClient(const shared_ptr<Handler>& handler,
   client_ = shared_ptr<WSClientImpl>(new WSClientImpl(handler, WSRequestContext(), loop));
 }
 
+WSClient::WSClient(const shared_ptr<Handler>& handler,
+                   const WSRequestContext& request_context,
+                   const EventLoopPool& pool) {
+  shared_ptr<WSClientImpl> client = shared_ptr<WSClientImpl>(new WSClientImpl(handler, request_context, pool.GetEventLoop(0)));
+  client->SetEventLoopPool(pool.GetImpl());
+  client_ = client;
+}
+
 void WSClient::SetWSRequestContext(const WSRequestContext& request_context) {
   if (client_) {
     static_pointer_cast<WSClientImpl>(client_)->SetWSRequestContext(request_context);
@@ -26,7 +26,7 @@ class WSClientImpl : public ClientImpl {
   linear::WSSocket CreateSocket(const std::string& hostname, int port,
                                 const linear::WSRequestContext& request_context,
                                 const linear::weak_ptr<HandlerDelegate>& delegate) {
-    return WSSocket(shared_ptr<WSSocketImpl>(new WSSocketImpl(hostname, port, request_context, loop_, delegate)));
+    return WSSocket(shared_ptr<WSSocketImpl>(new WSSocketImpl(hostname, port, request_context, NextLoop(), delegate)));
   }
  private:
   linear::WSRequestContext request_context_;
@@ -24,4 +24,10 @@ void WSServer::UseAuthentication(AuthContext::Type auth_type, const std::string&
   }
 }
 
+void WSServer::UseStatelessNonce(bool use) {
+  if (server_) {
+    static_pointer_cast<WSServerImpl>(server_)->UseStatelessNonce(use);
+  }
+}
+
 }  // namespace linear
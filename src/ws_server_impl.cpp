@@ -14,14 +14,14 @@ WSServerImpl::WSServerImpl(const weak_ptr<Handler>& handler,
                            AuthContext::Type auth_type, const std::string& realm,
                            const EventLoop& loop)
   : ServerImpl(handler, loop),
-    auth_type_(auth_type), realm_(realm), handle_(NULL) {
+    auth_type_(auth_type), realm_(realm), use_stateless_nonce_(false), handle_(NULL) {
 }
 
 WSServerImpl::~WSServerImpl() {
   Stop();
 }
 
-Error WSServerImpl::Start(const std::string& hostname, int port, EventLoopImpl::ServerEvent* ev) {
+Error WSServerImpl::Start(const std::string& hostname, int port, int backlog, EventLoopImpl::ServerEvent* ev) {
   lock_guard<mutex> lock(mutex_);
   if (state_ == START) {
     return Error(LNR_EALREADY);
@@ -56,7 +56,7 @@ Error WSServerImpl::Start(const std::string& hostname, int port, EventLoopImpl::
   std::ostringstream port_str;
   port_str << port;
   ret = tv_listen(reinterpret_cast<tv_stream_t*>(handle_),
-                  hostname.c_str(), port_str.str().c_str(), ServerImpl::BACKLOG, EventLoopImpl::OnAccept);
+                  hostname.c_str(), port_str.str().c_str(), backlog, EventLoopImpl::OnAccept);
   if (ret) {
     Error err(ret);
     LINEAR_LOG(LOG_ERR, "fail to start server(%s:%d,WS): %s",
@@ -117,6 +117,16 @@ void WSServerImpl::OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, in
     // create WSRequestContext from handshake->request
     tv_ws_t* handle = (tv_ws_t*) cli_stream;
     if (handle->handshake.response.code == WSHS_SUCCESS) {
+      // the socket is needed to finish the handshake, so reject by the response instead of closing
+      Error err = Admit();
+      if (err != Error(LNR_OK)) {
+        LINEAR_LOG(LOG_WARN, "reject connection at %s:%d,WS, reason = %s",
+                   (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
+                   self_.port,
+                   err.Message().c_str());
+        handle->handshake.response.code = WSHS_SERVICE_UNAVAILABLE;
+        return;
+      }
       if (handle->handshake.request.url.field_set & (1 << UF_PATH)) {
         request_context_.path = std::string(handle->handshake.request.url.field_value[UF_PATH].ptr);
       }
@@ -148,8 +158,12 @@ void WSServerImpl::OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, in
           return;
         }
         if (auth_type_ == AuthContext::DIGEST) {
-          impl.valid_nonce = nonce_pool_.IsValid(impl.nonce);
-          nonce_pool_.Remove(impl.nonce);
+          if (use_stateless_nonce_) {
+            impl.valid_nonce = stateless_nonce_.Consume(impl.nonce);
+          } else {
+            impl.valid_nonce = nonce_pool_.IsValid(impl.nonce);
+            nonce_pool_.Remove(impl.nonce);
+          }
         }
         AuthorizationContext authorization(shared_ptr<AuthorizationContextImpl>(new AuthorizationContextImpl(impl)));
         authorization.type = auth_type_;
@@ -223,32 +237,35 @@ void WSServerImpl::CreateAuthenticationHeader(tv_ws_t* handle) {
       return;
     }
     // create nonce: b64enc(24byte) => 32byte)
-    buffer b;
-    buffer_init(&b);
+    std::string nonce;
     Error e;
-    do {
-      if (buffer_fill_random(&b, 24) < 0 || buffer_to_base64(&b) < 0) {
-        handle->handshake.response.code = WSHS_INTERNAL_SERVER_ERROR;
-        buffer_fin(&b);
-        buffer_kv_fin(&kv);
-        return;
-      }
-      e = nonce_pool_.Add(std::string(b.ptr, b.len)); // remove after 1 min by default
-      if (e == Error(LNR_EALREADY)) {
-        buffer_reset(&b);
-      }
-    } while(e == Error(LNR_EALREADY));
-    if (e != Error(LNR_OK)) {
+    if (use_stateless_nonce_) {
+      e = stateless_nonce_.Issue(&nonce); // valid for 1 min by default
+    } else {
+      buffer b;
+      buffer_init(&b);
+      do {
+        if (buffer_fill_random(&b, 24) < 0 || buffer_to_base64(&b) < 0) {
+          buffer_fin(&b);
+          buffer_kv_fin(&kv);
+          return;
+        }
+        nonce = std::string(b.ptr, b.len);
+        e = nonce_pool_.Add(nonce); // remove after 1 min by default
+        if (e == Error(LNR_EALREADY)) {
+          buffer_reset(&b);
+        }
+      } while(e == Error(LNR_EALREADY));
       buffer_fin(&b);
+    }
+    if (e != Error(LNR_OK)) {
       buffer_kv_fin(&kv);
       return;
     }
-    if (buffer_append(&kv.val, b.ptr, b.len) < 0) {
-      buffer_fin(&b);
+    if (buffer_append(&kv.val, nonce.c_str(), nonce.size()) < 0) {
       buffer_kv_fin(&kv);
       return;
     }
-    buffer_fin(&b);
     if (buffer_append(&kv.val, CONST_STRING("\"")) < 0) {
       buffer_kv_fin(&kv);
       return;
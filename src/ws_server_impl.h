@@ -3,6 +3,7 @@
 
 #include "server_impl.h"
 #include "nonce_pool.h"
+#include "stateless_nonce.h"
 
 namespace linear {
 
@@ -13,7 +14,7 @@ class WSServerImpl : public ServerImpl {
                const std::string& realm,
                const linear::EventLoop& loop);
   virtual ~WSServerImpl();
-  linear::Error Start(const std::string& hostname, int port,
+  linear::Error Start(const std::string& hostname, int port, int backlog,
                       linear::EventLoopImpl::ServerEvent* ev);
   linear::Error Stop();
   void OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, int status);
@@ -21,13 +22,18 @@ class WSServerImpl : public ServerImpl {
     auth_type_ = auth_type;
     realm_ = realm;
   }
+  void UseStatelessNonce(bool use) {
+    use_stateless_nonce_ = use;
+  }
 
  private:
   void CreateAuthenticationHeader(tv_ws_t* handle);
 
   NoncePool nonce_pool_;
+  StatelessNonce stateless_nonce_;
   linear::AuthContext::Type auth_type_;
   std::string realm_;
+  bool use_stateless_nonce_;
   tv_ws_t* handle_;
 };
 
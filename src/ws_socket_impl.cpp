@@ -92,7 +92,8 @@ Error WSSocketImpl::Connect() {
   response_context_.headers.clear(); // clear response context
   std::ostringstream port_str;
   port_str << peer_.port;
-  ret = tv_connect(stream_, peer_.addr.c_str(), port_str.str().c_str(), EventLoopImpl::OnConnect);
+  // connect by host name even if its address is cached, libtv makes the Host header of the handshake from it
+  ret = tv_connect(stream_, host_.c_str(), port_str.str().c_str(), EventLoopImpl::OnConnect);
   if (ret) {
     assert(false); // never reach now
     free(stream_);
@@ -33,6 +33,16 @@ WSSClient::WSSClient(const shared_ptr<Handler>& handler, const EventLoop& loop)
   client_ = shared_ptr<WSSClientImpl>(new WSSClientImpl(handler, WSRequestContext(), SSLContext(), loop));
 }
 
+WSSClient::WSSClient(const shared_ptr<Handler>& handler,
+                     const WSRequestContext& request_context,
+                     const SSLContext& ssl_context,
+                     const EventLoopPool& pool) {
+  shared_ptr<WSSClientImpl> client =
+    shared_ptr<WSSClientImpl>(new WSSClientImpl(handler, request_context, ssl_context, pool.GetEventLoop(0)));
+  client->SetEventLoopPool(pool.GetImpl());
+  client_ = client;
+}
+
 void WSSClient::SetWSRequestContext(const WSRequestContext& request_context) {
   if (client_) {
     static_pointer_cast<WSSClientImpl>(client_)->SetWSRequestContext(request_context);
@@ -42,7 +42,7 @@ class WSSClientImpl : public ClientImpl {
                                  const linear::WSRequestContext& request_context,
                                  const linear::SSLContext& ssl_context,
                                  const linear::weak_ptr<HandlerDelegate>& delegate) {
-    return WSSSocket(shared_ptr<WSSSocketImpl>(new WSSSocketImpl(hostname, port, request_context, ssl_context, loop_, delegate)));
+    return WSSSocket(shared_ptr<WSSSocketImpl>(new WSSSocketImpl(hostname, port, request_context, ssl_context, NextLoop(), delegate)));
   }
  private:
   linear::WSRequestContext request_context_;
@@ -37,4 +37,10 @@ void WSSServer::UseAuthentication(AuthContext::Type auth_type, const std::string
   }
 }
 
+void WSSServer::UseStatelessNonce(bool use) {
+  if (server_) {
+    static_pointer_cast<WSSServerImpl>(server_)->UseStatelessNonce(use);
+  }
+}
+
 }  // namespace linear
@@ -16,14 +16,14 @@ WSSServerImpl::WSSServerImpl(const weak_ptr<Handler>& handler,
                              const std::string& realm,
                              const EventLoop& loop)
   : ServerImpl(handler, loop, true),
-    auth_type_(auth_type), realm_(realm), ssl_context_(ssl_context), handle_(NULL) {
+    auth_type_(auth_type), realm_(realm), use_stateless_nonce_(false), ssl_context_(ssl_context), handle_(NULL) {
 }
 
 WSSServerImpl::~WSSServerImpl() {
   Stop();
 }
 
-Error WSSServerImpl::Start(const std::string& hostname, int port, EventLoopImpl::ServerEvent* ev) {
+Error WSSServerImpl::Start(const std::string& hostname, int port, int backlog, EventLoopImpl::ServerEvent* ev) {
   lock_guard<mutex> lock(mutex_);
   if (state_ == START) {
     return Error(LNR_EALREADY);
@@ -58,7 +58,7 @@ Error WSSServerImpl::Start(const std::string& hostname, int port, EventLoopImpl:
   std::ostringstream port_str;
   port_str << port;
   ret = tv_listen(reinterpret_cast<tv_stream_t*>(handle_),
-                  hostname.c_str(), port_str.str().c_str(), ServerImpl::BACKLOG, EventLoopImpl::OnAccept);
+                  hostname.c_str(), port_str.str().c_str(), backlog, EventLoopImpl::OnAccept);
   if (ret) {
     Error err(ret);
     LINEAR_LOG(LOG_ERR, "fail to start server(%s:%d,WSS): %s",
@@ -119,6 +119,16 @@ void WSSServerImpl::OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, i
     // create WSRequestContext from handshake->request
     tv_wss_t* handle = (tv_wss_t*) cli_stream;
     if (handle->handshake.response.code == WSHS_SUCCESS) {
+      // the socket is needed to finish the handshake, so reject by the response instead of closing
+      Error err = Admit();
+      if (err != Error(LNR_OK)) {
+        LINEAR_LOG(LOG_WARN, "reject connection at %s:%d,WSS, reason = %s",
+                   (self_.proto == Addrinfo::IPv4) ? self_.addr.c_str() : (std::string("[" + self_.addr + "]")).c_str(),
+                   self_.port,
+                   err.Message().c_str());
+        handle->handshake.response.code = WSHS_SERVICE_UNAVAILABLE;
+        return;
+      }
       if (handle->handshake.request.url.field_set & (1 << UF_PATH)) {
         request_context_.path = std::string(handle->handshake.request.url.field_value[UF_PATH].ptr);
       }
@@ -150,8 +160,12 @@ void WSSServerImpl::OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, i
           return;
         }
         if (auth_type_ == AuthContext::DIGEST) {
-          impl.valid_nonce = nonce_pool_.IsValid(impl.nonce);
-          nonce_pool_.Remove(impl.nonce);
+          if (use_stateless_nonce_) {
+            impl.valid_nonce = stateless_nonce_.Consume(impl.nonce);
+          } else {
+            impl.valid_nonce = nonce_pool_.IsValid(impl.nonce);
+            nonce_pool_.Remove(impl.nonce);
+          }
         }
         AuthorizationContext authorization(shared_ptr<AuthorizationContextImpl>(new AuthorizationContextImpl(impl)));
         authorization.type = auth_type_;
@@ -225,31 +239,35 @@ void WSSServerImpl::CreateAuthenticationHeader(tv_wss_t* handle) {
       return;
     }
     // create nonce: b64enc(24byte) => 32byte)
-    buffer b;
-    buffer_init(&b);
+    std::string nonce;
     Error e;
-    do {
-      if (buffer_fill_random(&b, 24) < 0 || buffer_to_base64(&b) < 0) {
-        buffer_fin(&b);
-        buffer_kv_fin(&kv);
-        return;
-      }
-      e = nonce_pool_.Add(std::string(b.ptr, b.len)); // remove after 1 min by default
-      if (e == Error(LNR_EALREADY)) {
-        buffer_reset(&b);
-      }
-    } while(e == Error(LNR_EALREADY));
-    if (e != Error(LNR_OK)) {
+    if (use_stateless_nonce_) {
+      e = stateless_nonce_.Issue(&nonce); // valid for 1 min by default
+    } else {
+      buffer b;
+      buffer_init(&b);
+      do {
+        if (buffer_fill_random(&b, 24) < 0 || buffer_to_base64(&b) < 0) {
+          buffer_fin(&b);
+          buffer_kv_fin(&kv);
+          return;
+        }
+        nonce = std::string(b.ptr, b.len);
+        e = nonce_pool_.Add(nonce); // remove after 1 min by default
+        if (e == Error(LNR_EALREADY)) {
+          buffer_reset(&b);
+        }
+      } while(e == Error(LNR_EALREADY));
       buffer_fin(&b);
+    }
+    if (e != Error(LNR_OK)) {
       buffer_kv_fin(&kv);
       return;
     }
-    if (buffer_append(&kv.val, b.ptr, b.len) < 0) {
-      buffer_fin(&b);
+    if (buffer_append(&kv.val, nonce.c_str(), nonce.size()) < 0) {
       buffer_kv_fin(&kv);
       return;
     }
-    buffer_fin(&b);
     if (buffer_append(&kv.val, CONST_STRING("\"")) < 0) {
       buffer_kv_fin(&kv);
       return;
@@ -5,6 +5,7 @@
 
 #include "server_impl.h"
 #include "nonce_pool.h"
+#include "stateless_nonce.h"
 
 namespace linear {
 
@@ -16,7 +17,7 @@ class WSSServerImpl : public ServerImpl {
                 const std::string& realm,
                 const linear::EventLoop& loop);
   virtual ~WSSServerImpl();
-  linear::Error Start(const std::string& hostname, int port,
+  linear::Error Start(const std::string& hostname, int port, int backlog,
                       linear::EventLoopImpl::ServerEvent* ev);
   linear::Error Stop();
   void OnAccept(tv_stream_t* srv_stream, tv_stream_t* cli_stream, int status);
@@ -27,13 +28,18 @@ class WSSServerImpl : public ServerImpl {
     auth_type_ = auth_type;
     realm_ = realm;
   }
+  void UseStatelessNonce(bool use) {
+    use_stateless_nonce_ = use;
+  }
 
  private:
   void CreateAuthenticationHeader(tv_wss_t* handle);
 
   NoncePool nonce_pool_;
+  StatelessNonce stateless_nonce_;
   linear::AuthContext::Type auth_type_;
   std::string realm_;
+  bool use_stateless_nonce_;
   linear::SSLContext ssl_context_;
   tv_wss_t* handle_;
 };
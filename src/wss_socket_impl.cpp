@@ -102,7 +102,8 @@ Error WSSSocketImpl::Connect() {
   response_context_.headers.clear(); // clear response context
   std::ostringstream port_str;
   port_str << peer_.port;
-  ret = tv_connect(stream_, peer_.addr.c_str(), port_str.str().c_str(), EventLoopImpl::OnConnect);
+  // connect by host name even if its address is cached, libtv makes the Host header of the handshake from it
+  ret = tv_connect(stream_, host_.c_str(), port_str.str().c_str(), EventLoopImpl::OnConnect);
   if (ret) {
     assert(false); // never reach now
     free(stream_);
@@ -153,7 +154,7 @@ void WSSSocketImpl::SetWSResponseContext(const WSResponseContext& response_conte
 
 Error WSSSocketImpl::GetVerifyResult() {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTED && state_ != Socket::CONNECTING) {
+  if (state_.Load() != Socket::CONNECTED && state_.Load() != Socket::CONNECTING) {
     return Error(LNR_ENOTCONN);
   }
   int ret = tv_ssl_get_verify_result(reinterpret_cast<tv_wss_t*>(stream_)->ssl_handle);
@@ -166,7 +167,7 @@ Error WSSSocketImpl::GetVerifyResult() {
 
 bool WSSSocketImpl::PresentPeerCertificate() {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTED && state_ != Socket::CONNECTING) {
+  if (state_.Load() != Socket::CONNECTED && state_.Load() != Socket::CONNECTING) {
     return false;
   }
   X509* xcert = tv_ssl_get_peer_certificate(reinterpret_cast<tv_wss_t*>(stream_)->ssl_handle);
@@ -179,7 +180,7 @@ bool WSSSocketImpl::PresentPeerCertificate() {
 
 X509Certificate WSSSocketImpl::GetPeerCertificate() {
   lock_guard<mutex> state_lock(state_mutex_);
-  if (state_ != Socket::CONNECTED && state_ != Socket::CONNECTING) {
+  if (state_.Load() != Socket::CONNECTED && state_.Load() != Socket::CONNECTING) {
     throw std::runtime_error("peer certificate does not exist");
   }
   X509* xcert = tv_ssl_get_peer_certificate(reinterpret_cast<tv_wss_t*>(stream_)->ssl_handle);
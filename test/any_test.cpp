@@ -396,3 +396,33 @@ int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
 }
+
+TEST(AnyTest, sharedZone) {
+  std::vector<linear::type::any> v;
+  v.push_back(1);
+  v.push_back(std::string("string"));
+  linear::type::any a1(v);
+  linear::type::any a2(a1);
+  linear::type::any a3;
+  a3 = a1;
+  // copies share the same zone
+  EXPECT_EQ(&a1.zone(), &a2.zone());
+  EXPECT_EQ(&a1.zone(), &a3.zone());
+  EXPECT_EQ(a1.object().via.array.ptr, a2.object().via.array.ptr);
+
+  // assigning a new value does not affect other copies
+  a2 = std::string("other");
+  EXPECT_EQ(linear::type::any::STR, a2.type);
+  EXPECT_EQ("other", a2.as<std::string>());
+  EXPECT_NE(&a1.zone(), &a2.zone());
+  a3 = linear::type::nil();
+  EXPECT_TRUE(a3.is_nil());
+  std::vector<linear::type::any> got = a1.as<std::vector<linear::type::any> >();
+  ASSERT_EQ(2U, got.size());
+  EXPECT_EQ(1, got[0].as<int>());
+  EXPECT_EQ("string", got[1].as<std::string>());
+
+  // self assignment with its own object
+  a1 = a1.object().via.array.ptr[1];
+  EXPECT_EQ("string", a1.as<std::string>());
+}
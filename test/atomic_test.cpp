@@ -0,0 +1,27 @@
+#include "gtest/gtest.h"
+
+#include "linear/socket.h"
+
+#include "atomic.h"
+
+TEST(AtomicTest, loadStoreCompareExchange) {
+  linear::Atomic<linear::Socket::State> state(linear::Socket::DISCONNECTED);
+
+  ASSERT_EQ(linear::Socket::DISCONNECTED, state.Load());
+  state.Store(linear::Socket::CONNECTING);
+  ASSERT_EQ(linear::Socket::CONNECTING, state.Load());
+
+  ASSERT_FALSE(state.CompareExchange(linear::Socket::DISCONNECTING, linear::Socket::DISCONNECTED));
+  ASSERT_EQ(linear::Socket::CONNECTING, state.Load());
+  ASSERT_TRUE(state.CompareExchange(linear::Socket::CONNECTING, linear::Socket::CONNECTED));
+  ASSERT_EQ(linear::Socket::CONNECTED, state.Load());
+}
+
+TEST(AtomicTest, add) {
+  linear::Atomic<int> counter;
+
+  ASSERT_EQ(0, counter.Load());
+  ASSERT_EQ(3, counter.Add(3));
+  ASSERT_EQ(1, counter.Add(-2));
+  ASSERT_EQ(1, counter.Load());
+}
@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+
+#include "linear/tcp_client.h"
+
+#include "event_loop_pool_impl.h"
+
+TEST(EventLoopPoolTest, invalidSize) {
+  ASSERT_THROW(linear::EventLoopPool(0), std::invalid_argument);
+}
+
+TEST(EventLoopPoolTest, roundRobin) {
+  linear::EventLoopPool pool(3);
+  ASSERT_EQ(3U, pool.GetSize());
+  ASSERT_NE(pool.GetEventLoop(0).GetImpl(), pool.GetEventLoop(1).GetImpl());
+  ASSERT_NE(pool.GetEventLoop(1).GetImpl(), pool.GetEventLoop(2).GetImpl());
+  ASSERT_THROW(pool.GetEventLoop(3), std::out_of_range);
+
+  linear::shared_ptr<linear::EventLoopPoolImpl> impl = pool.GetImpl();
+  for (size_t i = 0; i < 6; i++) {
+    ASSERT_EQ(pool.GetEventLoop(i % 3).GetImpl(), impl->Next());
+  }
+}
+
+TEST(EventLoopPoolTest, leastSockets) {
+  linear::EventLoopPool pool(3, linear::EventLoopPool::LEAST_SOCKETS);
+  linear::shared_ptr<linear::EventLoopPoolImpl> impl = pool.GetImpl();
+
+  // used in turn while all loops have the same number of sockets
+  for (size_t i = 0; i < 3; i++) {
+    linear::shared_ptr<linear::EventLoopImpl> loop = impl->Next();
+    ASSERT_EQ(pool.GetEventLoop(i).GetImpl(), loop);
+    loop->IncreaseSockets();
+  }
+  pool.GetEventLoop(1).GetImpl()->DecreaseSockets();
+  ASSERT_EQ(pool.GetEventLoop(1).GetImpl(), impl->Next());
+  ASSERT_EQ(pool.GetEventLoop(1).GetImpl(), impl->Next());
+  pool.GetEventLoop(1).GetImpl()->IncreaseSockets();
+  ASSERT_EQ(pool.GetEventLoop(2).GetImpl(), impl->Next());
+
+  for (size_t i = 0; i < 3; i++) {
+    pool.GetEventLoop(i).GetImpl()->DecreaseSockets();
+    ASSERT_EQ(0U, pool.GetEventLoop(i).GetImpl()->GetNumOfSockets());
+  }
+}
+
+TEST(EventLoopPoolTest, socketsOfClient) {
+  linear::EventLoopPool pool(2);
+  linear::shared_ptr<linear::Handler> handler(new linear::Handler());
+  linear::TCPClient client(handler, pool);
+  {
+    linear::TCPSocket s1 = client.CreateSocket("127.0.0.1", 37800);
+    linear::TCPSocket s2 = client.CreateSocket("127.0.0.1", 37800);
+    ASSERT_EQ(1U, pool.GetEventLoop(0).GetImpl()->GetNumOfSockets());
+    ASSERT_EQ(1U, pool.GetEventLoop(1).GetImpl()->GetNumOfSockets());
+  }
+  ASSERT_EQ(0U, pool.GetEventLoop(0).GetImpl()->GetNumOfSockets());
+  ASSERT_EQ(0U, pool.GetEventLoop(1).GetImpl()->GetNumOfSockets());
+}
@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include "atomic.h"
+#include "executor_impl.h"
+
+class RecordTask : public linear::ExecutorImpl::Task {
+ public:
+  RecordTask(std::vector<int>* records, linear::mutex* mutex, int value, useconds_t usec = 0)
+    : records_(records), mutex_(mutex), value_(value), usec_(usec) {}
+  void Run() {
+    if (usec_ > 0) {
+      usleep(usec_);
+    }
+    linear::lock_guard<linear::mutex> lock(*mutex_);
+    records_->push_back(value_);
+  }
+
+ private:
+  std::vector<int>* records_;
+  linear::mutex* mutex_;
+  int value_;
+  useconds_t usec_;
+};
+
+TEST(ExecutorTest, invalidSize) {
+  ASSERT_THROW(linear::Executor(0), std::invalid_argument);
+}
+
+TEST(ExecutorTest, orderByKey) {
+  std::vector<int> records[2];
+  linear::mutex mutex;
+  {
+    linear::ExecutorImpl executor(2, 0);
+    ASSERT_EQ(2U, executor.GetNumOfThreads());
+    for (int i = 0; i < 100; i++) {
+      // key 0 and key 2 go to the same worker, and the first tasks are slower
+      executor.Post(0, new RecordTask(&records[0], &mutex, i, (i < 10) ? 1000 : 0));
+      executor.Post(1, new RecordTask(&records[1], &mutex, i));
+    }
+    // waiting tasks are executed before destruction
+  }
+  ASSERT_EQ(100U, records[0].size());
+  ASSERT_EQ(100U, records[1].size());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(i, records[0][i]);
+    ASSERT_EQ(i, records[1][i]);
+  }
+}
+
+TEST(ExecutorTest, stats) {
+  std::vector<int> records;
+  linear::mutex mutex;
+  linear::Executor executor(1, 2);
+  for (int i = 0; i < 5; i++) {
+    // blocks while 2 tasks are waiting
+    executor.GetImpl()->Post(0, new RecordTask(&records, &mutex, i, 10 * 1000));
+  }
+  linear::Executor::Stats stats = executor.GetStats();
+  ASSERT_GE(2U, stats.max_queued);
+  while (executor.GetStats().executed < 5) {
+    usleep(1000);
+  }
+  stats = executor.GetStats();
+  ASSERT_EQ(0U, stats.queued);
+  ASSERT_EQ(5U, stats.executed);
+  ASSERT_LT(0U, stats.max_wait);
+  ASSERT_LE(stats.max_wait, stats.total_wait);
+}
+
+class GateTask : public linear::ExecutorImpl::Task {
+ public:
+  explicit GateTask(linear::Atomic<bool>* open) : open_(open) {}
+  void Run() {
+    while (!open_->Load()) {
+      usleep(1000);
+    }
+  }
+
+ private:
+  linear::Atomic<bool>* open_;
+};
+
+struct LoopPostContext {
+  linear::ExecutorImpl* executor;
+  std::vector<int>* records;
+  linear::mutex* mutex;
+  int posted;
+};
+
+static void PostOnLoop(void* arg) {
+  LoopPostContext* context = static_cast<LoopPostContext*>(arg);
+  // behave as an event loop thread, the loop is never touched
+  static char loop;
+  linear::ThreadContext::Get()->SetLoop(reinterpret_cast<tv_loop_t*>(&loop));
+  for (int i = 0; i < 5; i++) {
+    if (context->executor->Post(0, new RecordTask(context->records, context->mutex, i), true)) {
+      context->posted++;
+    }
+  }
+  context->executor->Post(0, new RecordTask(context->records, context->mutex, 100));
+}
+
+TEST(ExecutorTest, neverBlockLoop) {
+  std::vector<int> records;
+  linear::mutex mutex;
+  linear::Atomic<bool> open(false);
+  linear::Executor executor(1, 2);
+  executor.GetImpl()->Post(0, new GateTask(&open));
+  while (executor.GetStats().queued > 0) {
+    usleep(1000);
+  }
+
+  // the worker is busy and the queue becomes full, but the loop thread never waits
+  LoopPostContext context = { executor.GetImpl().get(), &records, &mutex, 0 };
+  uv_thread_t thread;
+  ASSERT_EQ(0, uv_thread_create(&thread, PostOnLoop, &context));
+  uv_thread_join(&thread);
+  ASSERT_EQ(2, context.posted);
+  linear::Executor::Stats stats = executor.GetStats();
+  ASSERT_EQ(3U, stats.dropped);
+  ASSERT_EQ(3U, stats.queued);
+
+  open.Store(true);
+  while (executor.GetStats().queued > 0) {
+    usleep(1000);
+  }
+  executor.GetImpl()->Post(0, new GateTask(&open)); // wait for the last record
+  while (executor.GetStats().queued > 0) {
+    usleep(1000);
+  }
+  linear::lock_guard<linear::mutex> lock(mutex);
+  ASSERT_EQ(3U, records.size());
+  ASSERT_EQ(0, records[0]);
+  ASSERT_EQ(1, records[1]);
+  ASSERT_EQ(100, records[2]);
+}
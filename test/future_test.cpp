@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "linear/future.h"
+#include "linear/message.h"
+
+#include "future_impl.h"
+
+static std::vector<int> g_called;
+
+static void RecordFirst(void*) {
+  g_called.push_back(1);
+}
+
+static void RecordSecond(void*) {
+  g_called.push_back(2);
+}
+
+TEST(FutureTest, callbacks) {
+  g_called.clear();
+  linear::shared_ptr<linear::FutureImpl> impl(new linear::FutureImpl());
+  linear::Future future(impl);
+
+  // every awaiter is resumed, in order of registration
+  ASSERT_TRUE(future.OnReady(RecordFirst, NULL));
+  ASSERT_TRUE(future.OnReady(RecordSecond, NULL));
+  ASSERT_FALSE(future.IsReady());
+  impl->Complete(linear::Response(), linear::Error(linear::LNR_ECANCELED));
+  ASSERT_TRUE(future.IsReady());
+  ASSERT_EQ(2U, g_called.size());
+  ASSERT_EQ(1, g_called[0]);
+  ASSERT_EQ(2, g_called[1]);
+  ASSERT_EQ(linear::LNR_ECANCELED, future.GetError().Code());
+
+  // only the first completion takes effect, and callbacks are never called again
+  impl->Complete(linear::Response(), linear::Error(linear::LNR_ETIMEDOUT));
+  ASSERT_EQ(2U, g_called.size());
+  ASSERT_EQ(linear::LNR_ECANCELED, future.GetError().Code());
+  ASSERT_FALSE(future.OnReady(RecordFirst, NULL));
+  ASSERT_EQ(2U, g_called.size());
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+
+#include "test_common.h"
+
+#include "linear/tcp_client.h"
+
+#include "tv.h"
+
+using namespace linear;
+
+static bool IsSorted(const Group::Snapshot& snapshot) {
+  Group::Snapshot::const_iterator it = snapshot.begin(), prev = it;
+  size_t size = 0;
+  while (it != snapshot.end()) {
+    if (size++ > 0 && !(*prev < *it)) {
+      return false;
+    }
+    prev = it++;
+  }
+  return (size == snapshot.size());
+}
+
+TEST(GroupTest, snapshot) {
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  std::vector<TCPSocket> sockets;
+  for (int i = 0; i < 3; i++) {
+    sockets.push_back(cl.CreateSocket(TEST_ADDR, TEST_PORT));
+  }
+  const std::string name("group_test");
+
+  ASSERT_TRUE(Group::GetSnapshot(name).empty());
+  // joined in reverse order, and sorted by id
+  for (int i = 2; i >= 0; i--) {
+    Group::Join(name, sockets[i]);
+  }
+  Group::Join(name, sockets[0]);
+  Group::Snapshot joined = Group::GetSnapshot(name);
+  ASSERT_EQ(3U, joined.size());
+  ASSERT_TRUE(IsSorted(joined));
+  ASSERT_EQ(3U, Group::Get(name).size());
+
+  // snapshots taken before are never changed
+  Group::Leave(name, sockets[1]);
+  Group::Snapshot left = Group::GetSnapshot(name);
+  ASSERT_EQ(3U, joined.size());
+  ASSERT_EQ(2U, left.size());
+  ASSERT_TRUE(std::find(left.begin(), left.end(), sockets[1]) == left.end());
+
+  Group::LeaveAll(sockets[0]);
+  Group::LeaveAll(sockets[2]);
+  ASSERT_TRUE(Group::GetSnapshot(name).empty());
+  ASSERT_EQ(2U, left.size());
+}
+
+TEST(GroupTest, manySockets) {
+  static const size_t NUM = 1000;
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  std::vector<TCPSocket> sockets;
+  for (size_t i = 0; i < NUM; i++) {
+    sockets.push_back(cl.CreateSocket(TEST_ADDR, TEST_PORT));
+  }
+  const std::string name("group_test_many"), other("group_test_other");
+
+  // split into several chunks
+  for (size_t i = 0; i < NUM; i++) {
+    Group::Join(name, sockets[(i * 7) % NUM]);
+    if (i % 2 == 0) {
+      Group::Join(other, sockets[i]);
+    }
+  }
+  Group::Snapshot all = Group::GetSnapshot(name);
+  ASSERT_EQ(NUM, all.size());
+  ASSERT_TRUE(IsSorted(all));
+  ASSERT_EQ(NUM / 2, Group::GetSnapshot(other).size());
+
+  // leave from the middle of chunks and whole chunks
+  for (size_t i = 0; i < NUM; i += 3) {
+    Group::LeaveAll(sockets[i]);
+  }
+  Group::Snapshot rest = Group::GetSnapshot(name);
+  ASSERT_EQ(NUM - (NUM + 2) / 3, rest.size());
+  ASSERT_TRUE(IsSorted(rest));
+  ASSERT_TRUE(std::find(rest.begin(), rest.end(), sockets[3]) == rest.end());
+  ASSERT_TRUE(std::find(rest.begin(), rest.end(), sockets[4]) != rest.end());
+  ASSERT_EQ(NUM / 2 - (NUM + 5) / 6, Group::GetSnapshot(other).size());
+  ASSERT_EQ(NUM, all.size());
+
+  for (size_t i = 0; i < NUM; i++) {
+    Group::LeaveAll(sockets[i]);
+  }
+  ASSERT_TRUE(Group::GetSnapshot(name).empty());
+  ASSERT_TRUE(Group::GetSnapshot(other).empty());
+}
+
+struct GroupRaceContext {
+  std::vector<TCPSocket>* sockets;
+  std::vector<std::string>* names;
+  int mode;
+};
+
+static void RunGroupRace(void* arg) {
+  GroupRaceContext* context = static_cast<GroupRaceContext*>(arg);
+  std::vector<TCPSocket>& sockets = *context->sockets;
+  std::vector<std::string>& names = *context->names;
+  for (size_t n = 0; n < 200; n++) {
+    for (size_t i = 0; i < sockets.size(); i++) {
+      const std::string& name = names[(n + i) % names.size()];
+      switch (context->mode) {
+      case 0:
+        Group::Join(name, sockets[i]);
+        break;
+      case 1:
+        Group::Leave(name, sockets[i]);
+        break;
+      default:
+        Group::LeaveAll(sockets[i]);
+        break;
+      }
+    }
+  }
+}
+
+TEST(GroupTest, concurrentJoinLeave) {
+  static const size_t NUM = 32;
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  std::vector<TCPSocket> sockets;
+  for (size_t i = 0; i < NUM; i++) {
+    sockets.push_back(cl.CreateSocket(TEST_ADDR, TEST_PORT));
+  }
+  std::vector<std::string> names;
+  names.push_back("group_test_race0");
+  names.push_back("group_test_race1");
+  names.push_back("group_test_race2");
+
+  GroupRaceContext contexts[4];
+  uv_thread_t threads[4];
+  for (int i = 0; i < 4; i++) {
+    contexts[i].sockets = &sockets;
+    contexts[i].names = &names;
+    contexts[i].mode = (i < 2) ? 0 : i - 1; // 2 joiners, a leaver and a LeaveAll caller
+    ASSERT_EQ(0, uv_thread_create(&threads[i], RunGroupRace, &contexts[i]));
+  }
+  for (int i = 0; i < 4; i++) {
+    uv_thread_join(&threads[i]);
+  }
+
+  // LeaveAll must find every group that has the socket
+  for (size_t i = 0; i < NUM; i++) {
+    Group::LeaveAll(sockets[i]);
+  }
+  for (size_t i = 0; i < names.size(); i++) {
+    ASSERT_TRUE(Group::GetSnapshot(names[i]).empty());
+  }
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include "id_table.h"
+
+TEST(IdTableTest, insertFindRemove) {
+  linear::IdTable<int> table;
+  int values[3] = { 0, 1, 2 };
+
+  ASSERT_EQ(0U, table.size());
+  ASSERT_TRUE(table.Find(1) == NULL);
+  ASSERT_TRUE(table.Remove(1) == NULL);
+
+  ASSERT_TRUE(table.Insert(1, &values[0]));
+  ASSERT_TRUE(table.Insert(2, &values[1]));
+  ASSERT_TRUE(table.Insert(0xffffffff, &values[2]));
+  ASSERT_FALSE(table.Insert(2, &values[0]));
+  ASSERT_EQ(3U, table.size());
+  ASSERT_EQ(&values[0], table.Find(1));
+  ASSERT_EQ(&values[1], table.Find(2));
+  ASSERT_EQ(&values[2], table.Find(0xffffffff));
+
+  ASSERT_EQ(&values[1], table.Remove(2));
+  ASSERT_TRUE(table.Find(2) == NULL);
+  ASSERT_EQ(&values[0], table.Find(1));
+  ASSERT_EQ(&values[2], table.Find(0xffffffff));
+  ASSERT_EQ(2U, table.size());
+}
+
+TEST(IdTableTest, manyIds) {
+  static const uint32_t NUM = 50000;
+  linear::IdTable<uint32_t> table;
+  std::vector<uint32_t> values(NUM);
+
+  for (uint32_t i = 0; i < NUM; i++) {
+    values[i] = i;
+    // interleaved ids like msgids shared among sockets
+    ASSERT_TRUE(table.Insert(i * 3 + 1, &values[i]));
+  }
+  ASSERT_EQ(NUM, table.size());
+  // remove in other order than inserted to shift back clusters
+  for (uint32_t i = 0; i < NUM; i += 2) {
+    ASSERT_EQ(&values[i], table.Remove(i * 3 + 1));
+  }
+  for (uint32_t i = 0; i < NUM; i++) {
+    if (i % 2 == 0) {
+      ASSERT_TRUE(table.Find(i * 3 + 1) == NULL);
+    } else {
+      ASSERT_EQ(&values[i], table.Find(i * 3 + 1));
+    }
+  }
+  for (uint32_t i = 1; i < NUM; i += 2) {
+    ASSERT_EQ(&values[i], table.Remove(i * 3 + 1));
+  }
+  ASSERT_EQ(0U, table.size());
+  // shrunk after removing all
+  ASSERT_EQ(static_cast<size_t>(linear::IdTable<uint32_t>::INITIAL_CAPACITY), table.capacity());
+}
+
+TEST(IdTableTest, release) {
+  linear::IdTable<int> table;
+  int values[100];
+
+  for (int i = 0; i < 100; i++) {
+    values[i] = i;
+    ASSERT_TRUE(table.Insert(static_cast<uint32_t>(i), &values[i]));
+  }
+  std::vector<int*> released;
+  table.Release(&released);
+  ASSERT_EQ(0U, table.size());
+  ASSERT_EQ(100U, released.size());
+  int sum = 0;
+  for (std::vector<int*>::iterator it = released.begin(); it != released.end(); it++) {
+    sum += **it;
+  }
+  ASSERT_EQ(4950, sum);
+  ASSERT_TRUE(table.Find(0) == NULL);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "linear/log.h"
+
+#include "atomic.h"
+#include "tv.h"
+
+using namespace linear::log;
+
+static const int NUM_OF_THREADS = 4;
+static const int NUM_OF_RECORDS = 10000;
+
+static linear::Atomic<long> g_written;
+static linear::Atomic<long> g_dropped;
+static int g_last[NUM_OF_THREADS];
+static bool g_ordered = true;
+
+static void Callback(Level level, const char* file, int line, const char* func, const char* message) {
+  (void) file;
+  (void) line;
+  (void) func;
+  if (level == LOG_WARN) {
+    long dropped = 0;
+    if (sscanf(message, "%ld log records are dropped", &dropped) == 1) {
+      g_dropped.Add(dropped);
+    }
+    return;
+  }
+  int thread = 0, number = 0;
+  if (sscanf(message, "%d %d", &thread, &number) != 2 ||
+      thread < 0 || thread >= NUM_OF_THREADS || number <= g_last[thread]) {
+    g_ordered = false;
+    return;
+  }
+  g_last[thread] = number;
+  g_written.Add(1);
+}
+
+static void WriteRecords(void* arg) {
+  int thread = *static_cast<int*>(arg);
+  for (int i = 0; i < NUM_OF_RECORDS; i++) {
+    LINEAR_LOG(LOG_INFO, "%d %d", thread, i);
+  }
+}
+
+class LinearLogTest : public testing::Test {
+protected:
+  LinearLogTest() {}
+  ~LinearLogTest() {}
+  virtual void SetUp() {
+    g_written.Store(0);
+    g_dropped.Store(0);
+    memset(g_last, -1, sizeof(g_last));
+    g_ordered = true;
+    linear::log::SetLevel(linear::log::LOG_DEBUG);
+    ASSERT_TRUE(linear::log::EnableCallback(Callback));
+  }
+  virtual void TearDown() {
+    linear::log::DisableCallback();
+    linear::log::SetLevel(linear::log::LOG_OFF);
+  }
+  void WriteFromThreads() {
+    uv_thread_t threads[NUM_OF_THREADS];
+    int ids[NUM_OF_THREADS];
+    for (int i = 0; i < NUM_OF_THREADS; i++) {
+      ids[i] = i;
+      ASSERT_EQ(0, uv_thread_create(&threads[i], WriteRecords, &ids[i]));
+    }
+    for (int i = 0; i < NUM_OF_THREADS; i++) {
+      uv_thread_join(&threads[i]);
+    }
+    linear::log::DisableAsync();
+  }
+};
+
+TEST_F(LinearLogTest, async) {
+  ASSERT_TRUE(linear::log::EnableAsync(NUM_OF_THREADS * NUM_OF_RECORDS));
+  WriteFromThreads();
+  ASSERT_TRUE(g_ordered);
+  ASSERT_EQ(NUM_OF_THREADS * NUM_OF_RECORDS, g_written.Load());
+  ASSERT_EQ(0, g_dropped.Load());
+}
+
+TEST_F(LinearLogTest, asyncDrop) {
+  ASSERT_TRUE(linear::log::EnableAsync(16));
+  WriteFromThreads();
+  ASSERT_TRUE(g_ordered);
+  ASSERT_EQ(NUM_OF_THREADS * NUM_OF_RECORDS, g_written.Load() + g_dropped.Load());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
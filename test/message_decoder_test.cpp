@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include "message_decoder.h"
+
+template <typename Message>
+static void Unpack(const Message& message, msgpack::object_handle& handle) {
+  msgpack::sbuffer buffer;
+  msgpack::pack(buffer, message);
+  size_t offset = 0;
+  msgpack::unpack(handle, buffer.data(), buffer.size(), offset);
+}
+
+TEST(MessageDecoderTest, request) {
+  std::vector<linear::type::any> params;
+  params.push_back(1);
+  params.push_back(std::string("params"));
+  linear::Request request("method", params);
+  msgpack::object_handle handle;
+  Unpack(request, handle);
+
+  ASSERT_EQ(linear::REQUEST, linear::MessageDecoder::GetType(handle.get()));
+  linear::Request decoded;
+  linear::MessageDecoder::Decode(handle, &decoded);
+  ASSERT_EQ(request.msgid, decoded.msgid);
+  ASSERT_EQ(request.method, decoded.method);
+  ASSERT_EQ(request.params, decoded.params);
+  // params own the zone, and stay valid after handle is reused
+  Unpack(linear::Notify("other", 0), handle);
+  ASSERT_EQ(request.params, decoded.params);
+  linear::Request copied(decoded);
+  ASSERT_EQ(request.params, copied.params);
+}
+
+TEST(MessageDecoderTest, response) {
+  linear::Response response(1, std::string("result"));
+  msgpack::object_handle handle;
+  Unpack(response, handle);
+
+  ASSERT_EQ(linear::RESPONSE, linear::MessageDecoder::GetType(handle.get()));
+  linear::Response decoded;
+  linear::MessageDecoder::Decode(handle, &decoded);
+  ASSERT_EQ(response.msgid, decoded.msgid);
+  ASSERT_EQ(response.result, decoded.result);
+  ASSERT_TRUE(decoded.error.is_nil());
+
+  linear::Response error_response(2, linear::type::nil(), std::string("error"));
+  Unpack(error_response, handle);
+  linear::Response decoded_error;
+  linear::MessageDecoder::Decode(handle, &decoded_error);
+  ASSERT_EQ(error_response.msgid, decoded_error.msgid);
+  ASSERT_TRUE(decoded_error.result.is_nil());
+  ASSERT_EQ(error_response.error, decoded_error.error);
+}
+
+TEST(MessageDecoderTest, notify) {
+  linear::Notify notify("method", std::string("params"));
+  msgpack::object_handle handle;
+  Unpack(notify, handle);
+
+  ASSERT_EQ(linear::NOTIFY, linear::MessageDecoder::GetType(handle.get()));
+  linear::Notify decoded;
+  linear::MessageDecoder::Decode(handle, &decoded);
+  ASSERT_EQ(notify.method, decoded.method);
+  ASSERT_EQ(notify.params, decoded.params);
+}
+
+TEST(MessageDecoderTest, invalid) {
+  msgpack::object_handle handle;
+
+  Unpack(std::string("not a message"), handle);
+  ASSERT_EQ(linear::UNDEFINED, linear::MessageDecoder::GetType(handle.get()));
+
+  std::vector<int> unknown_type;
+  unknown_type.push_back(3);
+  unknown_type.push_back(0);
+  Unpack(unknown_type, handle);
+  ASSERT_EQ(linear::UNDEFINED, linear::MessageDecoder::GetType(handle.get()));
+
+  // too short Request
+  std::vector<int> short_request;
+  short_request.push_back(0);
+  short_request.push_back(1);
+  Unpack(short_request, handle);
+  ASSERT_EQ(linear::REQUEST, linear::MessageDecoder::GetType(handle.get()));
+  linear::Request request;
+  ASSERT_THROW(linear::MessageDecoder::Decode(handle, &request), std::bad_cast);
+
+  // Notify as Request
+  Unpack(linear::Notify("method", 0), handle);
+  ASSERT_THROW(linear::MessageDecoder::Decode(handle, &request), std::bad_cast);
+}
@@ -0,0 +1,204 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "linear/dispatcher.h"
+
+#include "method_table.h"
+
+TEST(MethodTableTest, insertFind) {
+  linear::MethodTable<int> table;
+  ASSERT_EQ(0U, table.size());
+  ASSERT_TRUE(table.Insert("echo", 1));
+  ASSERT_TRUE(table.Insert("add", 2));
+  ASSERT_FALSE(table.Insert("echo", 3));
+  ASSERT_EQ(2U, table.size());
+  ASSERT_EQ(1, *table.Find("echo"));
+  ASSERT_EQ(2, *table.Find("add"));
+  ASSERT_TRUE(table.Find("sub") == NULL);
+  ASSERT_TRUE(table.Find("") == NULL);
+}
+
+TEST(MethodTableTest, seal) {
+  linear::MethodTable<int> table;
+  for (int i = 0; i < 80; i++) {
+    std::ostringstream method;
+    method << "method" << i;
+    ASSERT_TRUE(table.Insert(method.str(), i));
+  }
+  ASSERT_LE(160U, table.capacity());
+  table.Seal();
+  ASSERT_TRUE(table.sealed());
+  ASSERT_FALSE(table.Insert("method80", 80));
+  for (int i = 0; i < 80; i++) {
+    std::ostringstream method;
+    method << "method" << i;
+    ASSERT_EQ(i, *table.Find(method.str()));
+  }
+  ASSERT_TRUE(table.Find("method80") == NULL);
+}
+
+TEST(MethodTableTest, sealCapacity) {
+  for (int num = 1; num <= 1024; num = num * 2 + 1) {
+    linear::MethodTable<int> table;
+    for (int i = 0; i < num; i++) {
+      std::ostringstream method;
+      method << "service.method_" << i;
+      ASSERT_TRUE(table.Insert(method.str(), i));
+    }
+    table.Seal();
+    // less than 2 slots per method, not growing with the square of methods
+    ASSERT_LE(table.capacity(), 2U * table.size());
+    for (int i = 0; i < num; i++) {
+      std::ostringstream method;
+      method << "service.method_" << i;
+      ASSERT_EQ(i, *table.Find(method.str()));
+    }
+    ASSERT_TRUE(table.Find("service.method_") == NULL);
+  }
+}
+
+static int g_requests = 0;
+static int g_notifies = 0;
+
+static void OnEcho(const linear::Socket&, const linear::Request& request) {
+  g_requests += request.params.as<int>();
+}
+
+struct OnLog {
+  OnLog(int* count) : count_(count) {}
+  void operator()(const linear::Socket&, const linear::Notify& notify) const {
+    *count_ += notify.params.as<int>();
+  }
+  int* count_;
+};
+
+class CountUnhandled : public linear::Dispatcher {
+ public:
+  CountUnhandled() : unhandled(0) {}
+  void OnUnhandledMessage(const linear::Socket&, const linear::Message&) {
+    unhandled++;
+  }
+  int unhandled;
+};
+
+TEST(MethodTableTest, dispatcher) {
+  CountUnhandled dispatcher;
+  ASSERT_EQ(linear::Error(linear::LNR_OK), dispatcher.RegisterRequest("echo", OnEcho));
+  ASSERT_EQ(linear::Error(linear::LNR_OK), dispatcher.RegisterNotify("log", OnLog(&g_notifies)));
+  // same name for Request and Notify is allowed
+  ASSERT_EQ(linear::Error(linear::LNR_OK), dispatcher.RegisterNotify("echo", OnLog(&g_notifies)));
+  ASSERT_EQ(linear::Error(linear::LNR_EEXIST), dispatcher.RegisterRequest("echo", OnEcho));
+  ASSERT_EQ(linear::Error(linear::LNR_OK), dispatcher.Seal());
+  ASSERT_EQ(linear::Error(linear::LNR_EALREADY), dispatcher.RegisterRequest("add", OnEcho));
+
+  linear::Socket socket;
+  dispatcher.OnMessage(socket, linear::Request("echo", 1));
+  dispatcher.OnMessage(socket, linear::Notify("log", 10));
+  dispatcher.OnMessage(socket, linear::Notify("echo", 100));
+  dispatcher.OnMessage(socket, linear::Request("log", 1000));
+  dispatcher.OnMessage(socket, linear::Response(1, 10000));
+  ASSERT_EQ(1, g_requests);
+  ASSERT_EQ(110, g_notifies);
+  ASSERT_EQ(2, dispatcher.unhandled);
+}
+
+// records messages sent through it instead of writing them
+class RecordSocket : public linear::Socket {
+ public:
+  using linear::Socket::Send;
+  linear::Error Send(const linear::Message& message, int) const {
+    responses.push_back(message.as<linear::Response>());
+    return linear::Error(linear::LNR_OK);
+  }
+  mutable std::vector<linear::Response> responses;
+};
+
+struct Point {
+  Point() : x(0), y(0) {}
+  Point(int x_, int y_) : x(x_), y(y_) {}
+  int x, y;
+  LINEAR_PACK(x, y);
+};
+
+static int g_voids = 0;
+
+TEST(MethodTableTest, bind) {
+  linear::Dispatcher dispatcher;
+  ASSERT_EQ(linear::Error(linear::LNR_OK),
+            dispatcher.Bind("add", [](int a, const std::string& b) { return b + std::to_string(a); }));
+  ASSERT_EQ(linear::Error(linear::LNR_OK), dispatcher.Bind("count", [](int n) { g_voids += n; }));
+  ASSERT_EQ(linear::Error(linear::LNR_OK), dispatcher.Bind("zero", []() { return 42; }));
+  ASSERT_EQ(linear::Error(linear::LNR_OK),
+            dispatcher.Bind("flip", [](const Point& p) { return Point(p.y, p.x); }));
+  ASSERT_EQ(linear::Error(linear::LNR_OK),
+            dispatcher.Bind("sum", [](const std::vector<int>& v) {
+                int sum = 0;
+                for (size_t i = 0; i < v.size(); i++) {
+                  sum += v[i];
+                }
+                return sum;
+              }));
+  ASSERT_EQ(linear::Error(linear::LNR_OK), dispatcher.Bind("throw", [](int) -> int { throw std::bad_cast(); }));
+  ASSERT_EQ(linear::Error(linear::LNR_OK), dispatcher.Seal());
+
+  RecordSocket socket;
+  std::vector<linear::type::any> params;
+
+  // arguments are converted by position
+  params.push_back(1);
+  params.push_back(std::string("a"));
+  dispatcher.OnMessage(socket, linear::Request("add", params));
+  ASSERT_EQ(1U, socket.responses.size());
+  ASSERT_EQ(std::string("a1"), socket.responses.back().result.as<std::string>());
+  ASSERT_TRUE(socket.responses.back().error.is_nil());
+
+  // arguments that do not convert, or the wrong number of them
+  dispatcher.OnMessage(socket, linear::Request("add", std::vector<int>(2, 1)));
+  ASSERT_EQ(2U, socket.responses.size());
+  ASSERT_EQ(std::string("invalid params"), socket.responses.back().error.as<std::string>());
+  dispatcher.OnMessage(socket, linear::Request("add", std::vector<int>(3, 1)));
+  ASSERT_EQ(3U, socket.responses.size());
+  ASSERT_EQ(std::string("invalid params"), socket.responses.back().error.as<std::string>());
+
+  // void result is answered as nil
+  dispatcher.OnMessage(socket, linear::Request("count", std::vector<int>(1, 5)));
+  ASSERT_EQ(4U, socket.responses.size());
+  ASSERT_EQ(5, g_voids);
+  ASSERT_TRUE(socket.responses.back().result.is_nil());
+  ASSERT_TRUE(socket.responses.back().error.is_nil());
+
+  // zero arity takes nil or an empty array
+  dispatcher.OnMessage(socket, linear::Request("zero", linear::type::nil()));
+  ASSERT_EQ(42, socket.responses.back().result.as<int>());
+  dispatcher.OnMessage(socket, linear::Request("zero", std::vector<int>()));
+  ASSERT_EQ(42, socket.responses.back().result.as<int>());
+  dispatcher.OnMessage(socket, linear::Request("zero", std::vector<int>(1, 0)));
+  ASSERT_EQ(std::string("invalid params"), socket.responses.back().error.as<std::string>());
+
+  // LINEAR_PACK struct as the argument and the result, wrapped in an array or not
+  dispatcher.OnMessage(socket, linear::Request("flip", Point(1, 2)));
+  Point flipped = socket.responses.back().result.as<Point>();
+  ASSERT_EQ(2, flipped.x);
+  ASSERT_EQ(1, flipped.y);
+  dispatcher.OnMessage(socket, linear::Request("flip", std::vector<Point>(1, Point(3, 4))));
+  flipped = socket.responses.back().result.as<Point>();
+  ASSERT_EQ(4, flipped.x);
+  ASSERT_EQ(3, flipped.y);
+
+  // the sole element is unwrapped only if it converts
+  dispatcher.OnMessage(socket, linear::Request("sum", std::vector<int>(2, 3)));
+  ASSERT_EQ(6, socket.responses.back().result.as<int>());
+  dispatcher.OnMessage(socket, linear::Request("sum", std::vector<int>(1, 3)));
+  ASSERT_EQ(3, socket.responses.back().result.as<int>());
+  dispatcher.OnMessage(socket, linear::Request("sum", std::vector<std::vector<int> >(1, std::vector<int>(2, 3))));
+  ASSERT_EQ(6, socket.responses.back().result.as<int>());
+
+  // exceptions from the function are not taken as invalid params
+  size_t sent = socket.responses.size();
+  ASSERT_THROW(dispatcher.OnMessage(socket, linear::Request("throw", std::vector<int>(1, 0))), std::bad_cast);
+  ASSERT_EQ(sent, socket.responses.size());
+}
@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+
+#include "test_common.h"
+
+#include "linear/packed_message.h"
+
+typedef LinearTest PackedMessageTest;
+
+TEST_F(PackedMessageTest, empty) {
+  linear::PackedMessage packed;
+  ASSERT_EQ(linear::UNDEFINED, packed.GetType());
+  ASSERT_TRUE(packed.GetData() == NULL);
+  ASSERT_EQ(0U, packed.GetSize());
+  ASSERT_EQ(linear::LNR_EBADF, packed.Send(linear::Socket()).Code());
+}
+
+TEST_F(PackedMessageTest, fromMessage) {
+  linear::Request request(METHOD_NAME, Params());
+  linear::PackedMessage packed_request(request);
+  ASSERT_EQ(linear::REQUEST, packed_request.GetType());
+  ASSERT_LT(0U, packed_request.GetSize());
+
+  linear::Response response(request.msgid, Params());
+  linear::PackedMessage packed_response(response);
+  ASSERT_EQ(linear::RESPONSE, packed_response.GetType());
+  ASSERT_LT(0U, packed_response.GetSize());
+
+  linear::Notify notify(METHOD_NAME, Params());
+  linear::PackedMessage packed_notify(notify);
+  ASSERT_EQ(linear::NOTIFY, packed_notify.GetType());
+  ASSERT_LT(0U, packed_notify.GetSize());
+
+  linear::PackedMessage copy(packed_notify);
+  ASSERT_EQ(packed_notify.GetData(), copy.GetData());
+  copy = packed_request;
+  ASSERT_EQ(packed_request.GetData(), copy.GetData());
+
+  linear::Message message;
+  linear::PackedMessage packed_invalid(message);
+  ASSERT_EQ(linear::UNDEFINED, packed_invalid.GetType());
+}
+
+TEST_F(PackedMessageTest, fromRawData) {
+  linear::Notify notify(METHOD_NAME, Params());
+  msgpack::sbuffer notify_buffer;
+  msgpack::pack(notify_buffer, notify);
+  linear::PackedMessage packed_notify(notify_buffer.data(), notify_buffer.size());
+  ASSERT_EQ(linear::NOTIFY, packed_notify.GetType());
+  ASSERT_EQ(notify_buffer.size(), packed_notify.GetSize());
+  ASSERT_EQ(0, memcmp(notify_buffer.data(), packed_notify.GetData(), notify_buffer.size()));
+
+  // msgid of Request is packed as uint32 to be patched
+  linear::Request request(METHOD_NAME, Params());
+  msgpack::sbuffer request_buffer;
+  msgpack::pack(request_buffer, request);
+  linear::PackedMessage packed_request(request_buffer.data(), request_buffer.size());
+  ASSERT_EQ(linear::REQUEST, packed_request.GetType());
+  ASSERT_EQ(static_cast<char>(0xce), packed_request.GetData()[2]);
+
+  linear::PackedMessage packed_truncated(notify_buffer.data(), notify_buffer.size() - 1);
+  ASSERT_EQ(linear::UNDEFINED, packed_truncated.GetType());
+  const char garbage[] = { static_cast<char>(0x93), 0x05, 0x00, 0x00 };
+  linear::PackedMessage packed_garbage(garbage, sizeof(garbage));
+  ASSERT_EQ(linear::UNDEFINED, packed_garbage.GetType());
+}
@@ -0,0 +1,52 @@
+#include "test_common.h"
+
+#include "resolver.h"
+
+TEST(ResolverTest, numeric) {
+  linear::Addrinfo::Protocol proto = linear::Addrinfo::UNKNOWN;
+
+  ASSERT_TRUE(linear::Resolver::IsNumeric("127.0.0.1", &proto));
+  ASSERT_EQ(linear::Addrinfo::IPv4, proto);
+  ASSERT_TRUE(linear::Resolver::IsNumeric("::1", &proto));
+  ASSERT_EQ(linear::Addrinfo::IPv6, proto);
+  ASSERT_FALSE(linear::Resolver::IsNumeric("localhost"));
+  ASSERT_FALSE(linear::Resolver::IsNumeric(""));
+
+  linear::Addrinfo info = linear::Resolver::Lookup("::1", 10000);
+  ASSERT_EQ("::1", info.addr);
+  ASSERT_EQ(10000, info.port);
+  ASSERT_EQ(linear::Addrinfo::IPv6, info.proto);
+
+  // numeric hosts are never cached
+  linear::Addrinfo other = linear::Resolver::Lookup("192.168.0.1", 10000);
+  linear::Resolver::Store("::1", other);
+  info = linear::Resolver::Lookup("::1", 10000);
+  ASSERT_EQ("::1", info.addr);
+}
+
+TEST(ResolverTest, cache) {
+  linear::Resolver::Clear();
+  linear::Addrinfo info = linear::Resolver::Lookup("resolver.test", 10000);
+  ASSERT_EQ("resolver.test", info.addr);
+  ASSERT_EQ(10000, info.port);
+  ASSERT_EQ(linear::Addrinfo::UNKNOWN, info.proto);
+
+  linear::Resolver::Store("resolver.test", linear::Resolver::Lookup("192.168.0.1", 10000));
+  info = linear::Resolver::Lookup("resolver.test", 10001);
+  ASSERT_EQ("192.168.0.1", info.addr);
+  ASSERT_EQ(10001, info.port);
+  ASSERT_EQ(linear::Addrinfo::IPv4, info.proto);
+
+  linear::Resolver::Remove("resolver.test");
+  info = linear::Resolver::Lookup("resolver.test", 10000);
+  ASSERT_EQ("resolver.test", info.addr);
+  ASSERT_EQ(linear::Addrinfo::UNKNOWN, info.proto);
+}
+
+TEST(ResolverTest, expire) {
+  linear::Resolver::Clear();
+  linear::Resolver::Store("resolver.test", linear::Resolver::Lookup("::1", 10000), 100);
+  ASSERT_EQ("::1", linear::Resolver::Lookup("resolver.test", 10000).addr);
+  msleep(150);
+  ASSERT_EQ("resolver.test", linear::Resolver::Lookup("resolver.test", 10000).addr);
+}
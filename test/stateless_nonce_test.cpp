@@ -0,0 +1,50 @@
+#include "test_common.h"
+
+#include "stateless_nonce.h"
+
+TEST(StatelessNonceTest, issueConsume) {
+  linear::StatelessNonce nonce;
+  std::string n1, n2;
+
+  ASSERT_EQ(linear::LNR_OK, nonce.Issue(&n1).Code());
+  ASSERT_EQ(linear::LNR_OK, nonce.Issue(&n2).Code());
+  ASSERT_EQ(32U, n1.size());
+  ASSERT_NE(n1, n2);
+
+  ASSERT_TRUE(nonce.Consume(n2));
+  ASSERT_TRUE(nonce.Consume(n1));
+  // replay
+  ASSERT_FALSE(nonce.Consume(n1));
+  ASSERT_FALSE(nonce.Consume(n2));
+}
+
+TEST(StatelessNonceTest, invalid) {
+  linear::StatelessNonce nonce, other;
+  std::string n;
+
+  ASSERT_EQ(linear::LNR_OK, nonce.Issue(&n).Code());
+  ASSERT_FALSE(other.Consume(n));
+  ASSERT_FALSE(nonce.Consume(""));
+  ASSERT_FALSE(nonce.Consume("invalid nonce"));
+  std::string tampered(n);
+  tampered[10] = (tampered[10] == 'A') ? 'B' : 'A';
+  ASSERT_FALSE(nonce.Consume(tampered));
+  ASSERT_TRUE(nonce.Consume(n));
+}
+
+TEST(StatelessNonceTest, expire) {
+  linear::StatelessNonce nonce(100);
+  std::string n;
+
+  ASSERT_EQ(linear::LNR_OK, nonce.Issue(&n).Code());
+  msleep(150);
+  ASSERT_FALSE(nonce.Consume(n));
+
+  // used nonces are kept across generations while valid
+  for (int i = 0; i < 50; i++) {
+    ASSERT_EQ(linear::LNR_OK, nonce.Issue(&n).Code());
+    msleep(3);
+    ASSERT_TRUE(nonce.Consume(n));
+    ASSERT_FALSE(nonce.Consume(n));
+  }
+}
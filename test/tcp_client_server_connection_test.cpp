@@ -141,6 +141,101 @@ TEST_F(TCPClientServerConnectionTest, ConnectEinval) {
   ASSERT_EQ(LNR_EINVAL, e.Code());
 }
 
+// Start with invalid backlog
+TEST_F(TCPClientServerConnectionTest, StartEinval) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+
+  Error e = sv.Start(TEST_ADDR, TEST_PORT, 0);
+  ASSERT_EQ(LNR_EINVAL, e.Code());
+}
+
+// Reject over MaxClients at accept
+TEST_F(TCPClientServerConnectionTest, MaxClients) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  TCPSocket cs1 = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+  TCPSocket cs2 = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+
+  ASSERT_EQ(LNR_OK, sv.SetMaxClients(1).Code());
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  // cs2 is closed at accept without calling OnConnect of the server
+  EXPECT_CALL(*sh, OnConnectMock(_))
+    .WillOnce(Assign(&srv_connected, true));
+  EXPECT_CALL(*sh, OnDisconnectMock(_, _))
+    .Times(::testing::AtLeast(0));
+  EXPECT_CALL(*ch, OnConnectMock(cs1))
+    .WillOnce(Assign(&cli_connected, true));
+  EXPECT_CALL(*ch, OnDisconnectMock(cs1, _))
+    .Times(::testing::AtLeast(0));
+  EXPECT_CALL(*ch, OnConnectMock(cs2))
+    .Times(::testing::AtLeast(0));
+  EXPECT_CALL(*ch, OnDisconnectMock(cs2, _))
+    .WillOnce(Assign(&cli_tested, true));
+
+  e = cs1.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_CONNECTED();
+
+  e = cs2.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_CLI_TESTED();
+}
+
+// Reject over MaxAcceptRate at accept
+TEST_F(TCPClientServerConnectionTest, MaxAcceptRate) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  TCPSocket cs1 = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+  TCPSocket cs2 = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+
+  ASSERT_EQ(LNR_OK, sv.SetMaxAcceptRate(1).Code());
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  // cs2 is closed at accept without calling OnConnect of the server
+  EXPECT_CALL(*sh, OnConnectMock(_))
+    .WillOnce(Assign(&srv_connected, true));
+  EXPECT_CALL(*sh, OnDisconnectMock(_, _))
+    .Times(::testing::AtLeast(0));
+  EXPECT_CALL(*ch, OnConnectMock(cs1))
+    .WillOnce(Assign(&cli_connected, true));
+  EXPECT_CALL(*ch, OnDisconnectMock(cs1, _))
+    .Times(::testing::AtLeast(0));
+  EXPECT_CALL(*ch, OnConnectMock(cs2))
+    .Times(::testing::AtLeast(0));
+  EXPECT_CALL(*ch, OnDisconnectMock(cs2, _))
+    .WillOnce(Assign(&cli_tested, true));
+
+  e = cs1.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_CONNECTED();
+
+  e = cs2.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_CLI_TESTED();
+}
+
 // Connect - Disconnect from Client in front thread
 TEST_F(TCPClientServerConnectionTest, DisconnectFromClientFT) {
   shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
@@ -1,5 +1,6 @@
 #include "test_common.h"
 
+#include "linear/packed_message.h"
 #include "linear/tcp_client.h"
 #include "linear/tcp_server.h"
 
@@ -269,6 +270,59 @@ TEST_F(TCPClientServerSendRecvTest, RequestFromClientFTNotResponseFromServer) {
   ASSERT_EQ(req.msgid, err_req.msgid);
 }
 
+// Send Request without timeout from Client in front thread and not Send Response from Server
+TEST_F(TCPClientServerSendRecvTest, RequestWithoutTimeoutFromClientFT) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  TCPSocket cs = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  EXPECT_CALL(*sh, OnConnectMock(_))
+    .WillOnce(Assign(&srv_connected, true));
+  EXPECT_CALL(*sh, OnMessageMock(Eq(ByRef(sh->s_)), _))
+    .Times(::testing::AtLeast(0));
+  EXPECT_CALL(*sh, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&srv_tested, true));
+  EXPECT_CALL(*ch, OnConnectMock(cs))
+    .WillOnce(Assign(&cli_connected, true));
+  EXPECT_CALL(*ch, OnMessageMock(cs, _))
+    .Times(0);
+  EXPECT_CALL(*ch, OnErrorMock(cs, _, Error(LNR_ETIMEDOUT)))
+    .Times(0);
+  EXPECT_CALL(*ch, OnErrorMock(cs, _, Error(LNR_ECANCELED)));
+  EXPECT_CALL(*ch, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&cli_tested, true));
+
+  e = cs.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_CONNECTED();
+
+  Params msg;
+  Request req(std::string(METHOD_NAME), msg);
+  e = req.Send(cs, 0);
+  ASSERT_EQ(LNR_OK, e.Code());
+  msleep(100);
+  cs.Disconnect();
+  WAIT_TESTED();
+
+  // check message in client side
+  ASSERT_TRUE(ch->err_m_ != NULL);
+  ASSERT_EQ(REQUEST, ch->err_m_->type);
+  Request err_req = ch->err_m_->as<Request>();
+  ASSERT_EQ(req.msgid, err_req.msgid);
+}
+
 // Send Request from Server in front thread and not Send Response from Client(Timeout)
 TEST_F(TCPClientServerSendRecvTest, RequestFromServerFTNotResponseFromClient) {
   shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
@@ -451,6 +505,53 @@ TEST_F(TCPClientServerSendRecvTest, NotifyFromClientFT) {
   ASSERT_EQ(notif.params, recv_notif.params);
 }
 
+// Send Notify bigger than a read from Client in front thread
+TEST_F(TCPClientServerSendRecvTest, BigNotifyFromClientFT) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  TCPSocket cs = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  EXPECT_CALL(*sh, OnConnectMock(_));
+  EXPECT_CALL(*sh, OnMessageMock(Eq(ByRef(sh->s_)), _))
+    .Times(2)
+    .WillOnce(::testing::Return())
+    .WillOnce(WithArg<0>(Disconnect()));
+  EXPECT_CALL(*sh, OnDisconnectMock(Eq(ByRef(sh->s_)), _))
+    .WillOnce(Assign(&srv_tested, true));
+  EXPECT_CALL(*ch, OnConnectMock(cs));
+  EXPECT_CALL(*ch, OnDisconnectMock(cs, _))
+    .WillOnce(Assign(&cli_tested, true));
+
+  e = cs.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  Notify small(std::string(METHOD_NAME), Params());
+  e = small.Send(cs);
+  ASSERT_EQ(LNR_OK, e.Code());
+  Notify notif(std::string(METHOD_NAME), std::string(1024 * 1024, 'a'));
+  e = notif.Send(cs);
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_TESTED();
+
+  // check message in server side
+  ASSERT_TRUE(sh->m_ != NULL);
+  ASSERT_EQ(NOTIFY, sh->m_->type);
+  Notify recv_notif = sh->m_->as<Notify>();
+  ASSERT_EQ(notif.method, recv_notif.method);
+  ASSERT_EQ(notif.params, recv_notif.params);
+}
+
 // Send Notify from Server in front thread
 TEST_F(TCPClientServerSendRecvTest, NotifyFromServerFT) {
   shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
@@ -879,3 +980,264 @@ TEST_F(TCPClientServerSendRecvTest, NotOverflowSendBuffer) {
   WAIT_CONNECTED();
   WAIT_TESTED();
 }
+
+// Send Notifies gathered by write coalescing
+TEST_F(TCPClientServerSendRecvTest, WriteCoalescing) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  TCPSocket cs = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  EXPECT_CALL(*sh, OnConnectMock(_))
+    .WillOnce(DoAll(Assign(&srv_connected, true),
+                    WithArg<0>(EnableWriteCoalescing(1000)),
+                    WithArg<0>(MultiSendNotify(10, 0))));
+  EXPECT_CALL(*sh, OnErrorMock(_, _, _))
+    .Times(0);
+  EXPECT_CALL(*sh, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&srv_tested, true));
+  {
+    InSequence dummy;
+    EXPECT_CALL(*ch, OnConnectMock(cs))
+      .WillOnce(Assign(&cli_connected, true));
+    EXPECT_CALL(*ch, OnMessageMock(_, _))
+      .Times(9);
+    EXPECT_CALL(*ch, OnMessageMock(_, _))
+      .WillOnce(WithArg<0>(Disconnect()));
+    EXPECT_CALL(*ch, OnDisconnectMock(_, _))
+      .WillOnce(Assign(&cli_tested, true));
+  }
+
+  e = cs.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_CONNECTED();
+  WAIT_TESTED();
+}
+
+// Send PackedMessage of Request twice from Client
+TEST_F(TCPClientServerSendRecvTest, PackedRequestFromClientFT) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  TCPSocket cs = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  EXPECT_CALL(*sh, OnConnectMock(_));
+  EXPECT_CALL(*sh, OnMessageMock(Eq(ByRef(sh->s_)), _))
+    .Times(2)
+    .WillRepeatedly(WithArgs<0, 1>(SendResponse()));
+  EXPECT_CALL(*sh, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&srv_tested, true));
+  EXPECT_CALL(*ch, OnConnectMock(cs));
+  {
+    InSequence dummy;
+    EXPECT_CALL(*ch, OnMessageMock(cs, _));
+    EXPECT_CALL(*ch, OnMessageMock(cs, _))
+      .WillOnce(WithArgs<0>(Disconnect()));
+  }
+  EXPECT_CALL(*ch, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&cli_tested, true));
+
+  e = cs.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  Params msg;
+  Request req(std::string(METHOD_NAME), msg);
+  PackedMessage packed(req);
+  ASSERT_EQ(REQUEST, packed.GetType());
+  e = packed.Send(cs);
+  ASSERT_EQ(LNR_OK, e.Code());
+  e = cs.Send(packed);
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  WAIT_TESTED();
+
+  // check message in client side
+  ASSERT_TRUE(ch->m_ != NULL);
+  ASSERT_EQ(RESPONSE, ch->m_->type);
+  Response resp = ch->m_->as<Response>();
+  ASSERT_NE(req.msgid, resp.msgid);
+  ASSERT_EQ(resp.msgid, resp.request.msgid);
+  ASSERT_EQ(std::string(METHOD_NAME), resp.request.method);
+  ASSERT_EQ(req.params, resp.result);
+}
+
+// Send Requests by SendAsync from Client in front thread and wait Futures
+TEST_F(TCPClientServerSendRecvTest, SendAsyncFromClientFT) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  TCPSocket cs = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  EXPECT_CALL(*sh, OnConnectMock(_))
+    .WillOnce(Assign(&srv_connected, true));
+  EXPECT_CALL(*sh, OnMessageMock(Eq(ByRef(sh->s_)), _))
+    .Times(3)
+    .WillRepeatedly(WithArgs<0, 1>(SendResponse()));
+  EXPECT_CALL(*sh, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&srv_tested, true));
+  EXPECT_CALL(*ch, OnConnectMock(cs))
+    .WillOnce(Assign(&cli_connected, true));
+  // results are delivered to Futures instead of the handler
+  EXPECT_CALL(*ch, OnMessageMock(cs, _))
+    .Times(0);
+  EXPECT_CALL(*ch, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&cli_tested, true));
+
+  e = cs.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_CONNECTED();
+
+  Params msg;
+  std::vector<Request> reqs;
+  std::vector<Future> futures;
+  for (int i = 0; i < 3; i++) {
+    reqs.push_back(Request(std::string(METHOD_NAME), msg));
+    futures.push_back(reqs.back().SendAsync(cs, 0));
+  }
+  for (size_t i = 0; i < futures.size(); i++) {
+    ASSERT_EQ(LNR_OK, futures[i].GetError().Code());
+    ASSERT_TRUE(futures[i].IsReady());
+    const Response& resp = futures[i].GetResponse();
+    ASSERT_EQ(reqs[i].msgid, resp.msgid);
+    ASSERT_EQ(reqs[i].msgid, resp.request.msgid);
+    ASSERT_EQ(reqs[i].params, resp.result);
+  }
+  cs.Disconnect();
+  WAIT_TESTED();
+}
+
+// SendAsync from Client in front thread and not Send Response from Server
+TEST_F(TCPClientServerSendRecvTest, SendAsyncTimeoutFromClientFT) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  TCPSocket cs = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  EXPECT_CALL(*sh, OnConnectMock(_))
+    .WillOnce(Assign(&srv_connected, true));
+  EXPECT_CALL(*sh, OnMessageMock(Eq(ByRef(sh->s_)), _))
+    .Times(::testing::AtLeast(0));
+  EXPECT_CALL(*sh, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&srv_tested, true));
+  EXPECT_CALL(*ch, OnConnectMock(cs))
+    .WillOnce(Assign(&cli_connected, true));
+  EXPECT_CALL(*ch, OnErrorMock(cs, _, _))
+    .Times(0);
+  EXPECT_CALL(*ch, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&cli_tested, true));
+
+  e = cs.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_CONNECTED();
+
+  Params msg;
+  Request req(std::string(METHOD_NAME), msg);
+  Future future = req.SendAsync(cs, 1);
+  ASSERT_EQ(LNR_ETIMEDOUT, future.GetError().Code());
+  cs.Disconnect();
+  WAIT_TESTED();
+
+  // fail to send after disconnected, and the future is already ready
+  Future failed = req.SendAsync(cs, 1);
+  ASSERT_TRUE(failed.IsReady());
+  ASSERT_NE(LNR_OK, failed.GetError().Code());
+}
+
+// Call from Client in front thread
+TEST_F(TCPClientServerSendRecvTest, CallFromClientFT) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPServer sv(sh);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  TCPClient cl(ch);
+  TCPSocket cs = cl.CreateSocket(TEST_ADDR, TEST_PORT);
+
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  EXPECT_CALL(*sh, OnConnectMock(_))
+    .WillOnce(Assign(&srv_connected, true));
+  EXPECT_CALL(*sh, OnMessageMock(Eq(ByRef(sh->s_)), _))
+    .Times(2)
+    .WillOnce(WithArgs<0, 1>(SendResponse()))
+    .WillOnce(::testing::Return());
+  EXPECT_CALL(*sh, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&srv_tested, true));
+  // Call must fail on the event loop thread instead of waiting forever
+  EXPECT_CALL(*ch, OnConnectMock(cs))
+    .WillOnce(DoAll(WithArgs<0>(CheckCallOnLoop()), Assign(&cli_connected, true)));
+  EXPECT_CALL(*ch, OnMessageMock(cs, _))
+    .Times(0);
+  EXPECT_CALL(*ch, OnErrorMock(cs, _, _))
+    .Times(0);
+  EXPECT_CALL(*ch, OnDisconnectMock(_, _))
+    .WillOnce(Assign(&cli_tested, true));
+
+  e = cs.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_CONNECTED();
+
+  Params msg;
+  Request req(std::string(METHOD_NAME), msg);
+  Response resp;
+  e = cs.Call(req, 0, &resp);
+  ASSERT_EQ(LNR_OK, e.Code());
+  ASSERT_EQ(req.msgid, resp.msgid);
+  ASSERT_EQ(req.params, resp.result);
+  ASSERT_TRUE(resp.error.is_nil());
+
+  // not Send Response from Server
+  e = cs.Call(req, 1, &resp);
+  ASSERT_EQ(LNR_ETIMEDOUT, e.Code());
+  cs.Disconnect();
+  WAIT_TESTED();
+}
@@ -270,6 +270,11 @@ ACTION_P2(MultiSendNotify, num, limit) {
     ASSERT_EQ(linear::Error(linear::LNR_OK), e);
   }
 }
+ACTION_P(EnableWriteCoalescing, cork_usec) {
+  linear::Socket s = arg0;
+  linear::Error e = s.SetWriteCoalescing(true, cork_usec);
+  ASSERT_EQ(linear::Error(linear::LNR_OK), e);
+}
 ACTION(CheckEbusy) {
   linear::Error e = arg0;
   ASSERT_EQ(linear::Error(linear::LNR_EBUSY), e);
@@ -290,6 +295,12 @@ ACTION(Disconnect) {
   linear::Socket s = arg0;
   s.Disconnect();
 }
+ACTION(CheckCallOnLoop) {
+  linear::Socket s = arg0;
+  linear::Response response;
+  linear::Error e = s.Call(linear::Request(std::string(METHOD_NAME), 0), 1, &response);
+  ASSERT_EQ(linear::Error(linear::LNR_EPERM), e);
+}
 
 namespace global {
 extern linear::Socket gs_;
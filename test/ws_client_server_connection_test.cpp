@@ -393,6 +393,50 @@ TEST_F(WSClientServerConnectionTest, AutoReconnect) {
   WAIT_TESTED();
 }
 
+// AutoReconnect with DigestAuthentication by stateless nonces
+TEST_F(WSClientServerConnectionTest, AutoReconnectWithStatelessNonce) {
+  shared_ptr<MockHandler> sh = linear::shared_ptr<MockHandler>(new MockHandler());
+  WSServer sv(sh, AuthContext::DIGEST, "realm is here");
+  sv.UseStatelessNonce(true);
+  shared_ptr<MockHandler> ch = linear::shared_ptr<MockHandler>(new MockHandler());
+  WSClient cl(ch);
+  WSRequestContext context;
+  // Digest Auth Validation (username = "user", password = "password")
+  context.authenticate.type = linear::AuthContext::DIGEST;
+  context.authenticate.username = USER_NAME;
+  context.authenticate.password = PASSWORD;
+  WSSocket cs = cl.CreateSocket(TEST_ADDR, TEST_PORT, context);
+
+  Error e;
+  for (int i = 0; i < 3; i++) {
+    e = sv.Start(TEST_ADDR, TEST_PORT);
+    if (e == linear::Error(LNR_OK)) {
+      break;
+    }
+    msleep(100);
+  }
+  ASSERT_EQ(LNR_OK, e.Code());
+
+  {
+    InSequence dummy;
+    EXPECT_CALL(*sh, OnConnectMock(_))
+      .WillOnce(WithArg<0>(CheckDigestAuthWS()));
+    EXPECT_CALL(*sh, OnDisconnectMock(Eq(ByRef(sh->s_)), _))
+      .WillOnce(Assign(&srv_tested, true));
+  }
+  {
+    InSequence dummy;
+    EXPECT_CALL(*ch, OnConnectMock(cs))
+      .WillOnce(WithArg<0>(Disconnect()));
+    EXPECT_CALL(*ch, OnDisconnectMock(cs, Error(LNR_OK)))
+      .WillOnce(Assign(&cli_tested, true));
+  }
+
+  e = cs.Connect();
+  ASSERT_EQ(LNR_OK, e.Code());
+  WAIT_TESTED();
+}
+
 namespace global {
 extern linear::Socket gs_;
 }